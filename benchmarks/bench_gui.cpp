@@ -0,0 +1,194 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    bench_gui.cpp
+
+    Measures the user visible paths on synthetic files saved to disk:
+
+    open/<layout>             MainWindow::openFile() until the automatic
+                              expansion of the tree has been scanned
+    open/<layout>/cached      the same, with the index saved by a previous open
+    hexview/<layout>          painting the viewport of the hex view at
+                              positions spread over the whole file
+    hexview/<layout>/select   the same, with a chunk selected around each position
+    hexview/<layout>/window   the same in the hex view of the main window,
+                              after opening the file
+    hexview/<layout>/overlay  the same, with the chunk structure coloured
+
+    Runs with the offscreen platform unless QT_QPA_PLATFORM says otherwise.
+*/
+
+#include <QApplication>
+#include <QEventLoop>
+#include <QPixmap>
+#include <QScrollBar>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTreeView>
+
+#include "QHexView/model/buffer/qmappedfilebuffer.h"
+#include "QHexView/qhexview.h"
+
+#include "benchlayouts.h"
+#include "benchreport.h"
+#include "mainwindow.h"
+#include "riffgenerator.h"
+
+namespace {
+
+constexpr int ViewportPositions{200};
+
+qint64 openAndWait(MainWindow &window, const QString &fileName)
+{
+    QElapsedTimer timer;
+    timer.start();
+    window.openFile(fileName);
+    auto *model = qobject_cast<TreeModel *>(window.findChild<QTreeView *>()->model());
+    if (model != nullptr && model->isLoading()) {
+        QEventLoop loop;
+        QObject::connect(model, &TreeModel::loadFinished, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+    return timer.nsecsElapsed();
+}
+
+void benchOpen(BenchReport &report, const QString &name, const QString &fileName, qint64 size)
+{
+    const QVariantMap params{{"bytes", size}};
+    for (const bool cached : {false, true}) {
+        const QString benchName = cached ? "open/" + name + "/cached" : "open/" + name;
+        if (!report.isSelected(benchName)) {
+            continue;
+        }
+        qint64 best = -1;
+        for (int i = 0; i < report.repeats(); ++i) {
+            auto *window = new MainWindow;
+            window->setCacheEnabled(cached);
+            if (cached) {
+                // the index is saved when the window is closed
+                openAndWait(*window, fileName);
+                window->close();
+                delete window;
+                window = new MainWindow;
+            }
+            const qint64 elapsed = openAndWait(*window, fileName);
+            best = best < 0 ? elapsed : qMin(best, elapsed);
+            delete window;
+        }
+        report.add(benchName, 1, best, params);
+    }
+}
+
+void benchHexView(BenchReport &report, const QString &name, const QString &fileName, qint64 size)
+{
+    auto *device = new QFile(fileName);
+    if (!device->open(QIODevice::ReadOnly)) {
+        delete device;
+        return;
+    }
+    QHexView view;
+    QHexDocument *document = QHexDocument::fromDevice<QMappedFileBuffer>(device, &view);
+    view.setDocument(document);
+    view.setReadOnly(true);
+    view.resize(1000, 800);
+    view.show();
+    QPixmap pixmap(view.viewport()->size());
+    QScrollBar *scrollBar = view.verticalScrollBar();
+    const QVariantMap params{{"bytes", size}, {"width", 1000}, {"height", 800}};
+
+    for (const bool selected : {false, true}) {
+        const QString benchName = selected ? "hexview/" + name + "/select" : "hexview/" + name;
+        report.measure(benchName, ViewportPositions, params, [&] {
+            for (int i = 0; i < ViewportPositions; ++i) {
+                scrollBar->setValue(int(qint64(scrollBar->maximum()) * i / (ViewportPositions - 1)));
+                if (selected) {
+                    const qint64 offset = size * i / ViewportPositions;
+                    view.hexCursor()->clearSelection();
+                    view.hexCursor()->move(offset);
+                    view.hexCursor()->select(offset);
+                    view.hexCursor()->selectSize(qMin(qint64(4096), size - offset));
+                }
+                view.viewport()->render(&pixmap);
+            }
+        });
+    }
+}
+
+// the main window, with and without the structure overlay updated at
+// every position, to compare the cost of the overlay alone
+void benchOverlay(BenchReport &report, const QString &name, const QString &fileName, qint64 size)
+{
+    const QString windowName = "hexview/" + name + "/window";
+    const QString overlayName = "hexview/" + name + "/overlay";
+    if (!report.isSelected(windowName) && !report.isSelected(overlayName)) {
+        return;
+    }
+    MainWindow window;
+    window.setCacheEnabled(false);
+    window.resize(1500, 800);
+    window.show();
+    openAndWait(window, fileName);
+    auto *view = window.findChild<QHexView *>();
+    if (view == nullptr) {
+        return;
+    }
+    QPixmap pixmap(view->viewport()->size());
+    QScrollBar *scrollBar = view->verticalScrollBar();
+    const QVariantMap params{{"bytes", size},
+                             {"width", view->viewport()->width()},
+                             {"height", view->viewport()->height()}};
+
+    for (const bool overlay : {false, true}) {
+        window.setOverlayEnabled(overlay);
+        report.measure(overlay ? overlayName : windowName, ViewportPositions, params, [&] {
+            for (int i = 0; i < ViewportPositions; ++i) {
+                scrollBar->setValue(int(qint64(scrollBar->maximum()) * i / (ViewportPositions - 1)));
+                // the overlay follows the scroll bar on the next pass of the event loop
+                QCoreApplication::processEvents();
+                view->viewport()->render(&pixmap);
+            }
+        });
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    // keeps the settings and the index cache of the application untouched
+    QCoreApplication::setOrganizationName("RiffTreeGUI-benchmarks");
+    QCoreApplication::setApplicationName("bench_gui");
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Open path and hex view benchmarks on synthetic RIFF files.");
+    parser.addHelpOption();
+    BenchReport report("bench_gui");
+    BenchLayouts layouts;
+    report.addOptions(parser);
+    layouts.addOptions(parser);
+    parser.process(app);
+    if (!report.parseOptions(parser) || !layouts.parseOptions(parser, report.isQuick())) {
+        return 1;
+    }
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        return 1;
+    }
+    for (const BenchLayout &layout : layouts.layouts()) {
+        const QString fileName = directory.filePath(layout.name + ".riff");
+        if (!RiffGenerator::save(layout.data, fileName)) {
+            return 1;
+        }
+        benchOpen(report, layout.name, fileName, layout.data.size());
+        benchHexView(report, layout.name, fileName, layout.data.size());
+        benchOverlay(report, layout.name, fileName, layout.data.size());
+    }
+    return report.finish();
+}
@@ -0,0 +1,540 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    bench_riff.cpp
+
+    Measures the parser and the tree model on synthetic files:
+
+    scan/<layout>          RiffScanner::scanTree(), per chunk
+    scan/<layout>/parallel the same, splitting subtrees across the global thread pool
+    search/<layout>        PatternSearch::find() of every "data" id in the file, per byte
+    carve/<layout>/parallel RiffScanner::carveContainers() on all cores, per byte
+    search/<layout>/parallel PatternSearch of the same pattern on all cores, per byte
+    hash/<layout>/xxh64    Xxh64 of the whole file, per byte
+    hash/<layout>/crc32    Crc32 of the whole file, per byte
+    hash/<layout>/parallel ChunkHash::hashNodes() of every leaf chunk on all cores, per byte
+    stats/<layout>         ChunkStats::collect() of the scanned table, per chunk
+    stats/<layout>/parallel the same, in slices on the global thread pool
+    query/<layout>/index   ChunkIndex::update() of the scanned table, per chunk
+    query/<layout>/id      ChunkQuery::run() of "data", found at any depth, per chunk
+    query/<layout>/path    ChunkQuery::run() of "//LIST(*)/*", the children of every list, per chunk
+    model/<layout>/load    TreeModel::loadData() and fetching every list, per chunk
+    model/<layout>/index   TreeModel::index() of every chunk, in tree order
+    model/<layout>/random  TreeModel::index() of random rows of random lists
+    model/<layout>/parent  TreeModel::parent() of every chunk
+    model/<layout>/data    TreeModel::data() of the three columns of every chunk
+    model/<layout>/labels  TreeModel::data() of the chunk column of every chunk, its label
+    model/<layout>/offset  TreeModel::indexAt() of random offsets of the file
+    mapping/<layout>/<policy>/open FileMapping::map() and scanTree() of the file out of the page cache
+    mapping/<layout>/<policy>/jump the first 64 KiB of random chunks of the file out of the page cache,
+                           prefetched as when they are selected, per chunk
+*/
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QPair>
+#include <QStringList>
+#include <QTemporaryFile>
+#include <QThreadPool>
+#include <QVector>
+#include <algorithm>
+#include <random>
+#include <utility>
+
+#include "benchlayouts.h"
+#include "benchreport.h"
+#include "chunkhash.h"
+#include "chunkquery.h"
+#include "chunkstats.h"
+#include "filemapping.h"
+#include "patternsearch.h"
+#include "treemodel.h"
+
+namespace {
+
+// fetches the lists one level at a time, waiting for all of them at once
+void fetchTree(TreeModel &model)
+{
+    QVector<QModelIndex> level{model.index(0, 0)};
+    while (!level.isEmpty()) {
+        bool pending = true;
+        while (pending) {
+            pending = false;
+            for (const QModelIndex &list : level) {
+                if (model.canFetchMore(list)) {
+                    model.fetchMore(list);
+                    pending = true;
+                }
+            }
+            if (pending && model.isLoading()) {
+                QEventLoop loop;
+                QObject::connect(&model, &TreeModel::loadFinished, &loop, &QEventLoop::quit);
+                loop.exec();
+            }
+        }
+        QVector<QModelIndex> next;
+        for (const QModelIndex &list : level) {
+            for (int row = 0; row < model.rowCount(list); ++row) {
+                const QModelIndex child = model.index(row, 0, list);
+                if (model.hasChildren(child)) {
+                    next.append(child);
+                }
+            }
+        }
+        level = std::move(next);
+    }
+}
+
+// every chunk of the model as a (parent, row) pair, in tree order
+QVector<QPair<QModelIndex, int>> collectRows(const TreeModel &model)
+{
+    QVector<QPair<QModelIndex, int>> rows;
+    QVector<QModelIndex> stack{QModelIndex{}};
+    while (!stack.isEmpty()) {
+        const QModelIndex parent = stack.takeLast();
+        const int count = model.rowCount(parent);
+        for (int row = 0; row < count; ++row) {
+            rows.append({parent, row});
+            const QModelIndex child = model.index(row, 0, parent);
+            if (model.rowCount(child) > 0) {
+                stack.append(child);
+            }
+        }
+    }
+    return rows;
+}
+
+void benchScan(BenchReport &report, const BenchLayout &layout)
+{
+    if (!report.isSelected("scan/" + layout.name)) {
+        return;
+    }
+    const auto *buffer = reinterpret_cast<const uint8_t *>(layout.data.constData());
+    ChunkTable table;
+    RiffScanner::scanTree(buffer, layout.data.size(), table);
+    QVariantMap params{{"bytes", layout.data.size()}, {"chunks", table.count()}};
+    report.measure("scan/" + layout.name, table.count(), params, [&] {
+        RiffScanner::scanTree(buffer, layout.data.size(), table);
+    });
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    params.insert("threads", pool->maxThreadCount());
+    report.measure("scan/" + layout.name + "/parallel", table.count(), params, [&] {
+        RiffScanner::scanTree(buffer, layout.data.size(), table, pool);
+    });
+}
+
+void benchSearch(BenchReport &report, const BenchLayout &layout)
+{
+    if (!report.isSelected("search/" + layout.name)) {
+        return;
+    }
+    const auto *buffer = reinterpret_cast<const uint8_t *>(layout.data.constData());
+    const uint8_t *end = buffer + layout.data.size();
+    const QByteArray pattern("data");
+    qint64 hits = 0;
+    const QVariantMap params{{"bytes", layout.data.size()}, {"pattern", QString(pattern)}};
+    report.measure("search/" + layout.name, layout.data.size(), params, [&] {
+        for (const uint8_t *pos = buffer;; ++pos) {
+            pos = PatternSearch::find(pos, end, pattern);
+            if (pos == end) {
+                break;
+            }
+            ++hits;
+        }
+    });
+
+    PatternSearch search;
+    search.setBuffer(buffer, layout.data.size());
+    report.measure("search/" + layout.name + "/parallel", layout.data.size(), params, [&] {
+        QEventLoop loop;
+        QObject::connect(&search, &PatternSearch::finished, &loop, &QEventLoop::quit);
+        search.start(pattern, 0, layout.data.size());
+        if (search.isRunning()) {
+            loop.exec();
+        }
+    });
+    if (hits == -1) {
+        qWarning("unexpected hits");
+    }
+}
+
+// Known answers from the reference implementations, fed in uneven pieces
+// so that the buffering of partial blocks is checked too. A benchmark of
+// a wrong hash is worthless, so any mismatch stops the program.
+bool checkHashes()
+{
+    struct Vector
+    {
+        QByteArray data;
+        quint64 seed;
+        quint64 xxh64;
+    };
+    QByteArray bytes(100, '\0');
+    for (int i = 0; i < bytes.size(); ++i) {
+        bytes[i] = char(i);
+    }
+    const Vector xxh64Vectors[]{
+        {QByteArray(), 0, Q_UINT64_C(0xEF46DB3751D8E999)},
+        {bytes.left(32), 0, Q_UINT64_C(0xCBF59C5116FF32B4)},
+        {bytes, 0, Q_UINT64_C(0x6AC1E58032166597)},
+        {bytes, Q_UINT64_C(0x9E3779B97F4A7C15), Q_UINT64_C(0x3B97D91EBA03E785)},
+    };
+    const QPair<QByteArray, quint32> crc32Vectors[]{
+        {QByteArray("123456789"), 0xCBF43926},
+        {bytes, 0x58C932F5},
+    };
+    const int pieces[]{1, 7, 31, 64};
+    bool passed = true;
+    for (const Vector &vector : xxh64Vectors) {
+        Xxh64 hash(vector.seed);
+        const auto *data = reinterpret_cast<const uint8_t *>(vector.data.constData());
+        size_t done = 0;
+        for (int i = 0; done < size_t(vector.data.size()); ++i) {
+            const size_t piece = qMin(size_t(pieces[i % 4]), size_t(vector.data.size()) - done);
+            hash.update(data + done, piece);
+            done += piece;
+        }
+        if (hash.digest() != vector.xxh64) {
+            qCritical("Xxh64 of %d bytes is %llx instead of %llx", int(vector.data.size()),
+                      static_cast<unsigned long long>(hash.digest()), static_cast<unsigned long long>(vector.xxh64));
+            passed = false;
+        }
+    }
+    for (const auto &vector : crc32Vectors) {
+        Crc32 hash;
+        const auto *data = reinterpret_cast<const uint8_t *>(vector.first.constData());
+        size_t done = 0;
+        for (int i = 0; done < size_t(vector.first.size()); ++i) {
+            const size_t piece = qMin(size_t(pieces[i % 4]), size_t(vector.first.size()) - done);
+            hash.update(data + done, piece);
+            done += piece;
+        }
+        if (hash.value() != vector.second) {
+            qCritical("Crc32 of %d bytes is %x instead of %x", int(vector.first.size()), hash.value(), vector.second);
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+void benchHash(BenchReport &report, const BenchLayout &layout)
+{
+    if (!report.isSelected("hash/" + layout.name)) {
+        return;
+    }
+    const auto *buffer = reinterpret_cast<const uint8_t *>(layout.data.constData());
+    const size_t length = size_t(layout.data.size());
+    quint64 checksum = 0;
+    QVariantMap params{{"bytes", layout.data.size()}};
+    report.measure("hash/" + layout.name + "/xxh64", layout.data.size(), params, [&] {
+        Xxh64 hash;
+        hash.update(buffer, length);
+        checksum += hash.digest();
+    });
+    report.measure("hash/" + layout.name + "/crc32", layout.data.size(), params, [&] {
+        Crc32 hash;
+        hash.update(buffer, length);
+        checksum += hash.value();
+    });
+
+    ChunkTable table;
+    RiffScanner::scanTree(buffer, layout.data.size(), table);
+    std::vector<int32_t> leaves;
+    qint64 payloads = 0;
+    for (int32_t n = 1; n <= table.count(); ++n) {
+        if (table.node(n).list == ChunkTable::NoNode) {
+            leaves.push_back(n);
+            payloads += ChunkHash::payloadLength(table.node(n), layout.data.size());
+        }
+    }
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const std::atomic<bool> cancelled{false};
+    params.insert("chunks", int(leaves.size()));
+    params.insert("threads", pool->maxThreadCount());
+    report.measure("hash/" + layout.name + "/parallel", payloads, params, [&] {
+        checksum += ChunkHash::hashNodes(buffer, layout.data.size(), table, leaves, pool, cancelled).size();
+    });
+    if (checksum == quint64(-1)) {
+        qWarning("unexpected checksum");
+    }
+}
+
+void benchStats(BenchReport &report, const BenchLayout &layout)
+{
+    if (!report.isSelected("stats/" + layout.name)) {
+        return;
+    }
+    const auto *buffer = reinterpret_cast<const uint8_t *>(layout.data.constData());
+    ChunkTable table;
+    RiffScanner::scanTree(buffer, layout.data.size(), table);
+    QVariantMap params{{"chunks", table.count()}};
+    size_t kinds = 0;
+    report.measure("stats/" + layout.name, table.count(), params, [&] {
+        kinds += ChunkStats::collect(table).size();
+    });
+    QThreadPool *pool = QThreadPool::globalInstance();
+    params.insert("threads", pool->maxThreadCount());
+    report.measure("stats/" + layout.name + "/parallel", table.count(), params, [&] {
+        kinds += ChunkStats::collect(table, pool).size();
+    });
+    if (kinds == 0) {
+        qWarning("unexpected kinds");
+    }
+}
+
+void benchQuery(BenchReport &report, const BenchLayout &layout)
+{
+    if (!report.isSelected("query/" + layout.name)) {
+        return;
+    }
+    const auto *buffer = reinterpret_cast<const uint8_t *>(layout.data.constData());
+    ChunkTable table;
+    RiffScanner::scanTree(buffer, layout.data.size(), table);
+    const QVariantMap params{{"chunks", table.count()}};
+    report.measure("query/" + layout.name + "/index", table.count(), params, [&] {
+        ChunkIndex index;
+        index.update(table);
+    });
+    ChunkIndex index;
+    index.update(table);
+    size_t matches = 0;
+    // the candidates of an id come from the index, a wildcard walks the lists
+    const std::pair<const char *, const char *> queries[]{{"id", "data"}, {"path", "//LIST(*)/*"}};
+    for (const auto &named : queries) {
+        ChunkQuery query;
+        QString error;
+        ChunkQuery::parse(QString::fromLatin1(named.second), query, error);
+        report.measure("query/" + layout.name + '/' + named.first, table.count(), params, [&] {
+            matches += query.run(table, index).size();
+        });
+    }
+    if (matches == size_t(-1)) {
+        qWarning("unexpected matches");
+    }
+}
+
+void benchCarve(BenchReport &report, const BenchLayout &layout)
+{
+    if (!report.isSelected("carve/" + layout.name)) {
+        return;
+    }
+    // every byte is searched for the container ids, inside the containers too
+    const auto *buffer = reinterpret_cast<const uint8_t *>(layout.data.constData());
+    const QVariantMap params{{"bytes", layout.data.size()}};
+    int containers = 0;
+    report.measure("carve/" + layout.name + "/parallel", layout.data.size(), params, [&] {
+        containers += RiffScanner::carveContainers(buffer, 0, layout.data.size(), QThreadPool::globalInstance()).size();
+    });
+    if (containers == -1) {
+        qWarning("unexpected containers");
+    }
+}
+
+void benchModel(BenchReport &report, const BenchLayout &layout)
+{
+    const auto *buffer = reinterpret_cast<const uint8_t *>(layout.data.constData());
+    const QString prefix = "model/" + layout.name + '/';
+    const QStringList names{"load", "index", "random", "parent", "data", "labels", "offset"};
+    if (std::none_of(names.begin(), names.end(), [&](const QString &name) {
+            return report.isSelected(prefix + name);
+        })) {
+        return;
+    }
+    TreeModel model;
+    model.loadData(buffer, layout.data.size());
+    fetchTree(model);
+    const QVariantMap params{{"bytes", layout.data.size()}, {"chunks", model.chunkCount()}};
+
+    report.measure(prefix + "load", model.chunkCount(), params, [&] {
+        TreeModel loaded;
+        loaded.loadData(buffer, layout.data.size());
+        fetchTree(loaded);
+    });
+
+    const QVector<QPair<QModelIndex, int>> rows = collectRows(model);
+    QVector<QModelIndex> indexes;
+    indexes.reserve(rows.size());
+    for (const auto &row : rows) {
+        indexes.append(model.index(row.second, 0, row.first));
+    }
+    qint64 checksum = 0;
+
+    report.measure(prefix + "index", rows.size(), params, [&] {
+        for (const auto &row : rows) {
+            checksum += model.index(row.second, 0, row.first).row();
+        }
+    });
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> pick(0, rows.size() - 1);
+    QVector<int> picked;
+    picked.reserve(rows.size());
+    for (int i = 0; i < rows.size(); ++i) {
+        picked.append(pick(random));
+    }
+    report.measure(prefix + "random", rows.size(), params, [&] {
+        for (const int i : picked) {
+            checksum += model.index(rows[i].second, 0, rows[i].first).row();
+        }
+    });
+
+    report.measure(prefix + "parent", indexes.size(), params, [&] {
+        for (const QModelIndex &index : indexes) {
+            checksum += model.parent(index).row();
+        }
+    });
+
+    report.measure(prefix + "data", indexes.size() * 3, params, [&] {
+        for (const QModelIndex &index : indexes) {
+            for (int column = 0; column < 3; ++column) {
+                checksum += model.data(index.sibling(index.row(), column), Qt::DisplayRole).isValid();
+            }
+        }
+    });
+
+    report.measure(prefix + "labels", indexes.size(), params, [&] {
+        for (const QModelIndex &index : indexes) {
+            checksum += model.data(index, Qt::DisplayRole).toString().size();
+        }
+    });
+
+    std::uniform_int_distribution<qint64> pickOffset(0, layout.data.size() - 1);
+    QVector<qint64> offsets;
+    offsets.reserve(rows.size());
+    for (int i = 0; i < rows.size(); ++i) {
+        offsets.append(pickOffset(random));
+    }
+    report.measure(prefix + "offset", offsets.size(), params, [&] {
+        for (const qint64 offset : offsets) {
+            checksum += model.indexAt(offset).row();
+        }
+    });
+
+    // keeps the compiler from dropping the loops
+    if (checksum == -1) {
+        qWarning("unexpected checksum");
+    }
+}
+
+void benchMapping(BenchReport &report, const BenchLayout &layout)
+{
+    const QString prefix = "mapping/" + layout.name + '/';
+    const QStringList policies = FileMapping::policyNames();
+    if (std::none_of(policies.begin(), policies.end(), [&](const QString &policy) {
+            return report.isSelected(prefix + policy + "/open") || report.isSelected(prefix + policy + "/jump");
+        })) {
+        return;
+    }
+    // the page cache of a file in tmpfs cannot be dropped, TMPDIR must be on a disk
+    QTemporaryFile file;
+    if (!file.open() || file.write(layout.data) != layout.data.size() || !file.flush()
+        || !FileMapping::evict(file)) {
+        qWarning("%s: the file cannot be read from the disk here", qPrintable(prefix));
+        return;
+    }
+    const qint64 size = layout.data.size();
+    ChunkTable table;
+    RiffScanner::scanTree(reinterpret_cast<const uint8_t *>(layout.data.constData()), size, table);
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int32_t> pick(1, table.count());
+    QVector<int32_t> jumps;
+    for (int i = 0; i < qMin(table.count(), report.isQuick() ? 100 : 1000); ++i) {
+        jumps.append(pick(random));
+    }
+
+    // the best of the runs, each one after dropping the file from the page cache
+    auto measureCold = [&](const QString &name, qint64 operations, const QVariantMap &params, auto work) {
+        if (!report.isSelected(name)) {
+            return;
+        }
+        qint64 best = -1;
+        for (int i = 0; i < report.repeats(); ++i) {
+            FileMapping::evict(file);
+            QElapsedTimer timer;
+            timer.start();
+            work();
+            const qint64 elapsed = timer.nsecsElapsed();
+            best = best < 0 ? elapsed : qMin(best, elapsed);
+        }
+        report.add(name, operations, best, params);
+    };
+
+    qint64 checksum = 0;
+    for (const QString &name : policies) {
+        const FileMapping::Policy policy = FileMapping::policy(name);
+        const QVariantMap params{{"bytes", size}, {"chunks", table.count()}, {"policy", name}};
+        measureCold(prefix + name + "/open", 1, params, [&] {
+            uint8_t *buffer = FileMapping::map(file, size, policy);
+            if (buffer == nullptr) {
+                return;
+            }
+            FileMapping::advise(buffer, size, policy, FileMapping::Sequential);
+            ChunkTable scanned;
+            RiffScanner::scanTree(buffer, size, scanned);
+            checksum += scanned.count();
+            FileMapping::unmap(file, buffer, size);
+        });
+
+        const QVariantMap jumpParams{{"jumps", jumps.size()}, {"chunks", table.count()}, {"policy", name}};
+        measureCold(prefix + name + "/jump", jumps.size(), jumpParams, [&] {
+            uint8_t *buffer = FileMapping::map(file, size, policy);
+            if (buffer == nullptr) {
+                return;
+            }
+            FileMapping::advise(buffer, size, policy, FileMapping::Random);
+            for (const int32_t n : jumps) {
+                const ChunkNode &node = table.node(n);
+                const qint64 offset = qint64(node.offset);
+                const qint64 length = RiffScanner::HeaderSize + qint64(node.size);
+                FileMapping::prefetch(buffer, size, policy, offset, length);
+                // the rows the hex view shows and the fields decoded from the chunk
+                const qint64 end = qMin(offset + qMin(length, qint64(64 << 10)), size);
+                for (qint64 pos = offset; pos < end; pos += 4096) {
+                    checksum += buffer[pos];
+                }
+            }
+            FileMapping::unmap(file, buffer, size);
+        });
+    }
+    // keeps the compiler from dropping the reads
+    if (checksum == -1) {
+        qWarning("unexpected checksum");
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bench_riff");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Parser and tree model benchmarks on synthetic RIFF files.");
+    parser.addHelpOption();
+    BenchReport report("bench_riff");
+    BenchLayouts layouts;
+    report.addOptions(parser);
+    layouts.addOptions(parser);
+    parser.process(app);
+    if (!report.parseOptions(parser) || !layouts.parseOptions(parser, report.isQuick())) {
+        return 1;
+    }
+    if (!checkHashes()) {
+        return 1;
+    }
+
+    for (const BenchLayout &layout : layouts.layouts()) {
+        benchScan(report, layout);
+        benchSearch(report, layout);
+        benchHash(report, layout);
+        benchStats(report, layout);
+        benchQuery(report, layout);
+        benchCarve(report, layout);
+        benchModel(report, layout);
+        benchMapping(report, layout);
+    }
+    return report.finish();
+}
@@ -0,0 +1,88 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    bench_treemodel.cpp
+
+    Measures TreeModel::index() and TreeModel::parent() on lists with an
+    increasing number of siblings. The cost per call should not depend on
+    the width of the list.
+*/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTextStream>
+#include <QVector>
+#include <random>
+
+#include "riffgenerator.h"
+#include "treemodel.h"
+
+namespace {
+
+void fetchAll(TreeModel &model, const QModelIndex &parent)
+{
+    while (model.canFetchMore(parent)) {
+        QEventLoop loop;
+        QObject::connect(&model, &TreeModel::loadFinished, &loop, &QEventLoop::quit);
+        model.fetchMore(parent);
+        loop.exec();
+    }
+}
+
+double nanosPerCall(qint64 elapsed, int calls)
+{
+    return calls > 0 ? double(elapsed) / calls : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    out << "siblings\tindex(seq) ns\tindex(rand) ns\tparent ns\n";
+
+    for (int siblings : {1000, 10000, 100000, 1000000}) {
+        const QByteArray buffer = RiffGenerator::wide(siblings);
+        TreeModel model;
+        model.loadData(reinterpret_cast<const uint8_t *>(buffer.constData()), buffer.size());
+        const QModelIndex riff = model.index(0, 0);
+        fetchAll(model, riff);
+        const QModelIndex list = model.index(0, 0, riff);
+        fetchAll(model, list);
+        const int rows = model.rowCount(list);
+
+        QElapsedTimer timer;
+        qint64 checksum = 0;
+
+        timer.start();
+        for (int row = 0; row < rows; ++row) {
+            checksum += model.index(row, 0, list).row();
+        }
+        const qint64 sequential = timer.nsecsElapsed();
+
+        std::mt19937 random(42);
+        std::uniform_int_distribution<int> pick(0, rows - 1);
+        QVector<QModelIndex> picked;
+        picked.reserve(rows);
+        timer.restart();
+        for (int i = 0; i < rows; ++i) {
+            picked.append(model.index(pick(random), 0, list));
+        }
+        const qint64 randomAccess = timer.nsecsElapsed();
+
+        timer.restart();
+        for (const QModelIndex &index : picked) {
+            checksum += model.parent(index).row();
+        }
+        const qint64 parents = timer.nsecsElapsed();
+
+        out << rows << '\t' << nanosPerCall(sequential, rows) << '\t'
+            << nanosPerCall(randomAccess, rows) << '\t' << nanosPerCall(parents, rows)
+            << "\t(" << checksum << ")\n";
+        out.flush();
+    }
+    return 0;
+}
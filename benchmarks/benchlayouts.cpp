@@ -0,0 +1,117 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    benchlayouts.cpp
+
+    Builds the synthetic RIFF files used by the benchmarks:
+
+    balanced  lists nested three levels deep, 16 children each
+    deep      binary tree of lists twelve levels deep
+    wide      one list with a million empty chunks
+    avi       AVI-like layout with a million frame chunks and an idx1 index
+    samples   few big chunks with exponential sizes, 256 MiB in total
+    damaged   balanced, with random bytes written over one header in 256
+    rifx      balanced, as a big endian RIFX file
+    iff       balanced, as a big endian IFF file with nested FORM chunks
+    custom    described by the --depth, --fanout, --sizes ... options
+*/
+
+#include <QDir>
+#include <QStringList>
+#include <cstdio>
+
+#include "benchlayouts.h"
+#include "riffgenerator.h"
+
+void BenchLayouts::addOptions(QCommandLineParser &parser)
+{
+    parser.addOption({"layouts",
+                      "Comma separated layouts: balanced, deep, wide, avi, samples, damaged, rifx, iff, custom.",
+                      "names",
+                      "balanced,deep,wide,avi,samples,rifx,iff"});
+    parser.addOption({"depth", "Levels of lists of the custom layout.", "levels", "3"});
+    parser.addOption({"fanout", "Children of every list of the custom layout.", "count", "8"});
+    parser.addOption({"sizes", "Chunk size distribution: fixed, uniform or exponential.", "name", "uniform"});
+    parser.addOption({"min-size", "Minimum chunk data size of the custom layout.", "bytes", "0"});
+    parser.addOption({"max-size", "Maximum chunk data size of the custom layout.", "bytes", "64"});
+    parser.addOption({"total-size", "Minimum file size of the custom layout.", "bytes", "0"});
+    parser.addOption({"seed", "Seed of the chunk sizes.", "number", "1"});
+    parser.addOption({"save", "Save the generated files into <directory>.", "directory"});
+}
+
+bool BenchLayouts::parseOptions(const QCommandLineParser &parser, bool quick)
+{
+    // the quick variants keep the shape of every layout at about 1% of the size
+    const int scale = quick ? 100 : 1;
+    m_saveDirectory = parser.value("save");
+
+    const QStringList names = parser.value("layouts").split(',');
+    for (const QString &name : names) {
+        RiffSpec spec;
+        if (name.isEmpty()) {
+            continue;
+        } else if (name == QLatin1String("balanced")) {
+            spec.depth = quick ? 2 : 3;
+            spec.fanout = 16;
+            m_layouts.append({name, RiffGenerator::tree(spec)});
+        } else if (name == QLatin1String("deep")) {
+            spec.depth = quick ? 6 : 12;
+            spec.fanout = 2;
+            m_layouts.append({name, RiffGenerator::tree(spec)});
+        } else if (name == QLatin1String("wide")) {
+            m_layouts.append({name, RiffGenerator::wide(1000000 / scale)});
+        } else if (name == QLatin1String("avi")) {
+            m_layouts.append({name, RiffGenerator::avi(500000 / scale)});
+        } else if (name == QLatin1String("samples")) {
+            spec.depth = 1;
+            spec.fanout = 16;
+            spec.maxSize = 4 * 1024 * 1024;
+            spec.sizes = RiffSpec::Sizes::Exponential;
+            spec.totalSize = 256 * 1024 * 1024 / scale;
+            m_layouts.append({name, RiffGenerator::tree(spec)});
+        } else if (name == QLatin1String("damaged")) {
+            spec.depth = quick ? 2 : 3;
+            spec.fanout = 16;
+            const QByteArray data = RiffGenerator::tree(spec);
+            m_layouts.append({name, RiffGenerator::damage(data, qMax(1, int(data.size() / (256 * 40))))});
+        } else if (name == QLatin1String("rifx") || name == QLatin1String("iff")) {
+            spec.depth = quick ? 2 : 3;
+            spec.fanout = 16;
+            spec.container = name == QLatin1String("rifx") ? RiffSpec::Container::Rifx : RiffSpec::Container::Iff;
+            m_layouts.append({name, RiffGenerator::tree(spec)});
+        } else if (name == QLatin1String("custom")) {
+            spec.depth = parser.value("depth").toInt();
+            spec.fanout = parser.value("fanout").toInt();
+            spec.minSize = parser.value("min-size").toUInt();
+            spec.maxSize = parser.value("max-size").toUInt();
+            spec.totalSize = parser.value("total-size").toLongLong();
+            spec.seed = parser.value("seed").toUInt();
+            if (!RiffGenerator::parseSizes(parser.value("sizes"), spec.sizes)) {
+                std::fprintf(stderr, "Unknown size distribution: %s\n", qPrintable(parser.value("sizes")));
+                return false;
+            }
+            m_layouts.append({name, RiffGenerator::tree(spec)});
+        } else {
+            std::fprintf(stderr, "Unknown layout: %s\n", qPrintable(name));
+            return false;
+        }
+    }
+    return save();
+}
+
+bool BenchLayouts::save() const
+{
+    if (m_saveDirectory.isEmpty()) {
+        return true;
+    }
+    QDir directory(m_saveDirectory);
+    for (const BenchLayout &layout : m_layouts) {
+        const QString fileName = directory.filePath(layout.name + ".riff");
+        if (!RiffGenerator::save(layout.data, fileName)) {
+            std::fprintf(stderr, "Cannot write %s\n", qPrintable(fileName));
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BENCHLAYOUTS_H
+#define BENCHLAYOUTS_H
+
+#include <QByteArray>
+#include <QCommandLineParser>
+#include <QString>
+#include <QVector>
+
+//
+// The synthetic files shared by the benchmark programs. A custom tree
+// layout can be described on the command line, and every layout can be
+// saved to disk to be opened in the application or used elsewhere.
+//
+
+struct BenchLayout
+{
+    QString name;
+    QByteArray data;
+};
+
+class BenchLayouts
+{
+public:
+    void addOptions(QCommandLineParser &parser);
+    bool parseOptions(const QCommandLineParser &parser, bool quick);
+
+    const QVector<BenchLayout> &layouts() const { return m_layouts; }
+    bool save() const;
+
+private:
+    QVector<BenchLayout> m_layouts;
+    QString m_saveDirectory;
+};
+
+#endif // BENCHLAYOUTS_H
@@ -0,0 +1,117 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    benchreport.cpp
+
+    Options and output shared by the benchmark programs.
+*/
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTextStream>
+#include <cstdio>
+
+#include "benchreport.h"
+
+BenchReport::BenchReport(const QString &suite)
+    : m_suite(suite)
+{}
+
+void BenchReport::addOptions(QCommandLineParser &parser)
+{
+    parser.addOption({"format", "Output format: text or json.", "format", m_format});
+    parser.addOption({"output", "Write the results to <file> instead of the standard output.", "file"});
+    parser.addOption({"filter", "Run only the benchmarks whose name contains <text>.", "text"});
+    parser.addOption({"label", "Free text stored with the results, like a commit id.", "text"});
+    parser.addOption({"repeats", "Runs of every benchmark, the fastest one is reported.", "count",
+                      QString::number(m_repeats)});
+    parser.addOption({"quick", "Use smaller inputs, for a quick check."});
+}
+
+bool BenchReport::parseOptions(const QCommandLineParser &parser)
+{
+    m_format = parser.value("format");
+    m_output = parser.value("output");
+    m_filter = parser.value("filter");
+    m_label = parser.value("label");
+    m_repeats = qMax(1, parser.value("repeats").toInt());
+    m_quick = parser.isSet("quick");
+    if (m_format != QLatin1String("text") && m_format != QLatin1String("json")) {
+        std::fprintf(stderr, "Unknown output format: %s\n", qPrintable(m_format));
+        return false;
+    }
+    return true;
+}
+
+bool BenchReport::isSelected(const QString &name) const
+{
+    return m_filter.isEmpty() || name.contains(m_filter);
+}
+
+void BenchReport::add(const QString &name, qint64 operations, qint64 nanoseconds, const QVariantMap &params)
+{
+    QJsonObject result;
+    result["name"] = name;
+    result["operations"] = operations;
+    result["ns"] = nanoseconds;
+    result["ns_per_op"] = operations > 0 ? double(nanoseconds) / double(operations) : 0.0;
+    result["params"] = QJsonObject::fromVariantMap(params);
+    // the whole input is processed by every run of those with a size
+    const double bytes = params.value("bytes").toDouble();
+    if (bytes > 0 && nanoseconds > 0) {
+        result["mb_per_s"] = bytes * 1e3 / double(nanoseconds);
+    }
+    m_results.append(result);
+    // progress goes to stderr, so that the results can be piped
+    std::fprintf(stderr, "%-40s %14.1f ns/op", qPrintable(name), result["ns_per_op"].toDouble());
+    if (result.contains("mb_per_s")) {
+        std::fprintf(stderr, " %10.1f MB/s", result["mb_per_s"].toDouble());
+    }
+    std::fprintf(stderr, "\n");
+}
+
+int BenchReport::finish() const
+{
+    QFile file(m_output);
+    const bool opened = m_output.isEmpty() ? file.open(stdout, QIODevice::WriteOnly)
+                                           : file.open(QIODevice::WriteOnly);
+    if (!opened) {
+        std::fprintf(stderr, "Cannot write %s\n", qPrintable(m_output));
+        return 1;
+    }
+
+    if (m_format == QLatin1String("json")) {
+        QJsonObject root;
+        root["suite"] = m_suite;
+        root["label"] = m_label;
+        root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        root["qt"] = QString(qVersion());
+        root["cpu"] = QSysInfo::currentCpuArchitecture();
+        root["os"] = QSysInfo::prettyProductName();
+        root["repeats"] = m_repeats;
+        root["results"] = m_results;
+        file.write(QJsonDocument(root).toJson());
+        return 0;
+    }
+
+    QTextStream out(&file);
+    out << m_suite;
+    if (!m_label.isEmpty()) {
+        out << " (" << m_label << ')';
+    }
+    out << "\n\nbenchmark\toperations\tns/op\tMB/s\n";
+    for (const auto &value : m_results) {
+        const QJsonObject result = value.toObject();
+        out << result["name"].toString() << '\t' << qint64(result["operations"].toDouble()) << '\t'
+            << result["ns_per_op"].toDouble() << '\t';
+        if (result.contains("mb_per_s")) {
+            out << result["mb_per_s"].toDouble();
+        }
+        out << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BENCHREPORT_H
+#define BENCHREPORT_H
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QString>
+#include <QVariantMap>
+
+//
+// Collects the results of a benchmark program and writes them either as
+// a table for people or as JSON to be compared between commits by tools.
+// Every result is the best of several runs, in nanoseconds per operation.
+//
+
+class BenchReport
+{
+public:
+    explicit BenchReport(const QString &suite);
+
+    void addOptions(QCommandLineParser &parser);
+    bool parseOptions(const QCommandLineParser &parser);
+
+    bool isSelected(const QString &name) const;
+    int repeats() const { return m_repeats; }
+    bool isQuick() const { return m_quick; }
+
+    // runs work() the configured number of times and records the fastest run
+    template<typename Work>
+    void measure(const QString &name, qint64 operations, const QVariantMap &params, Work work);
+
+    void add(const QString &name, qint64 operations, qint64 nanoseconds, const QVariantMap &params);
+    int finish() const;
+
+private:
+    QString m_suite;
+    QString m_format{"text"};
+    QString m_output;
+    QString m_filter;
+    QString m_label;
+    int m_repeats{3};
+    bool m_quick{false};
+    QJsonArray m_results;
+};
+
+template<typename Work>
+void BenchReport::measure(const QString &name, qint64 operations, const QVariantMap &params, Work work)
+{
+    if (!isSelected(name)) {
+        return;
+    }
+    qint64 best = -1;
+    for (int i = 0; i < m_repeats; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        work();
+        const qint64 elapsed = timer.nsecsElapsed();
+        best = best < 0 ? elapsed : qMin(best, elapsed);
+    }
+    add(name, operations, best, params);
+}
+
+#endif // BENCHREPORT_H
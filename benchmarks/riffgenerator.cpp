@@ -0,0 +1,231 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    riffgenerator.cpp
+
+    Synthetic RIFF layouts: balanced trees of lists with a configurable
+    distribution of chunk sizes, also as RIFX and IFF files, a single very wide list, and an AVI-like
+    file with one chunk per video and audio frame and an idx1 index.
+    Any of them can be damaged by overwriting some bytes after the RIFF
+    header, to measure the recovery of the scanner.
+*/
+
+#include <QFile>
+#include <QtEndian>
+#include <climits>
+#include <cstring>
+#include <random>
+
+#include "riffgenerator.h"
+
+namespace {
+
+class RiffWriter
+{
+public:
+    explicit RiffWriter(qint64 reserve, bool bigEndian = false)
+        : m_bigEndian(bigEndian)
+    {
+        m_data.reserve(int(qMin(reserve, qint64(INT_MAX))));
+    }
+
+    int beginList(const char *fourcc, const char *listType)
+    {
+        const int pos = m_data.size();
+        m_data.append(fourcc, 4);
+        appendWord(0);
+        m_data.append(listType, 4);
+        return pos;
+    }
+
+    void endList(int pos)
+    {
+        const quint32 size = toFile(quint32(m_data.size() - pos - 8));
+        std::memcpy(m_data.data() + pos + 4, &size, sizeof(size));
+    }
+
+    int chunk(const char *fourcc, quint32 size)
+    {
+        const int pos = m_data.size();
+        m_data.append(fourcc, 4);
+        appendWord(size);
+        m_data.append(int(size + (size & 1)), '\xaa');
+        return pos;
+    }
+
+    void appendWord(quint32 value)
+    {
+        value = toFile(value);
+        m_data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    int size() const { return m_data.size(); }
+    QByteArray &data() { return m_data; }
+
+private:
+    quint32 toFile(quint32 value) const { return m_bigEndian ? qToBigEndian(value) : qToLittleEndian(value); }
+
+    QByteArray m_data;
+    bool m_bigEndian;
+};
+
+class SizeSource
+{
+public:
+    explicit SizeSource(const RiffSpec &spec)
+        : m_spec(spec)
+        , m_random(spec.seed)
+        , m_uniform(spec.minSize, qMax(spec.minSize, spec.maxSize))
+        , m_exponential(4.0 / qMax(1.0, double(spec.maxSize) - spec.minSize))
+    {}
+
+    quint32 next()
+    {
+        switch (m_spec.sizes) {
+        case RiffSpec::Sizes::Fixed:
+            return m_spec.maxSize;
+        case RiffSpec::Sizes::Uniform:
+            return m_uniform(m_random);
+        case RiffSpec::Sizes::Exponential:
+            // mostly small chunks with a long tail, like the samples of a soundfont
+            return quint32(qMin(double(m_spec.maxSize), m_spec.minSize + m_exponential(m_random)));
+        }
+        return m_spec.minSize;
+    }
+
+private:
+    const RiffSpec &m_spec;
+    std::mt19937 m_random;
+    std::uniform_int_distribution<quint32> m_uniform;
+    std::exponential_distribution<double> m_exponential;
+};
+
+void subtree(RiffWriter &writer, SizeSource &sizes, const RiffSpec &spec, int level)
+{
+    // IFF groups nest FORM chunks, the others LIST chunks
+    const char *listId = spec.container == RiffSpec::Container::Iff ? "FORM" : "LIST";
+    for (int i = 0; i < spec.fanout; ++i) {
+        if (level <= spec.depth) {
+            const int list = writer.beginList(listId, "node");
+            subtree(writer, sizes, spec, level + 1);
+            writer.endList(list);
+        } else {
+            writer.chunk("data", sizes.next());
+        }
+    }
+}
+
+} // namespace
+
+QByteArray RiffGenerator::tree(const RiffSpec &spec)
+{
+    static const char *const containerIds[]{"RIFF", "RIFX", "FORM"};
+    SizeSource sizes(spec);
+    RiffWriter writer(spec.totalSize, spec.container != RiffSpec::Container::Riff);
+    const int riff = writer.beginList(containerIds[int(spec.container)], "BNCH");
+    do {
+        subtree(writer, sizes, spec, 1);
+    } while (writer.size() < spec.totalSize);
+    writer.endList(riff);
+    return writer.data();
+}
+
+QByteArray RiffGenerator::wide(int siblings)
+{
+    RiffWriter writer(qint64(siblings) * 8 + 24);
+    const int riff = writer.beginList("RIFF", "BNCH");
+    const int list = writer.beginList("LIST", "wide");
+    for (int i = 0; i < siblings; ++i) {
+        writer.chunk("data", 0);
+    }
+    writer.endList(list);
+    writer.endList(riff);
+    return writer.data();
+}
+
+QByteArray RiffGenerator::avi(int frames, quint32 videoSize, quint32 audioSize)
+{
+    const qint64 frameBytes = 16 + videoSize + (videoSize & 1) + audioSize + (audioSize & 1);
+    RiffWriter writer(frames * (frameBytes + 32) + 1024);
+    const int riff = writer.beginList("RIFF", "AVI ");
+
+    const int hdrl = writer.beginList("LIST", "hdrl");
+    writer.chunk("avih", 56);
+    int strl = writer.beginList("LIST", "strl");
+    writer.chunk("strh", 56);
+    writer.chunk("strf", 40);
+    writer.endList(strl);
+    strl = writer.beginList("LIST", "strl");
+    writer.chunk("strh", 56);
+    writer.chunk("strf", 18);
+    writer.endList(strl);
+    writer.endList(hdrl);
+
+    // idx1 offsets are relative to the list type of the movi list
+    const int movi = writer.beginList("LIST", "movi");
+    const int moviData = writer.size() - 4;
+    for (int i = 0; i < frames; ++i) {
+        writer.chunk("00dc", videoSize);
+        writer.chunk("01wb", audioSize);
+    }
+    writer.endList(movi);
+
+    writer.data().append("idx1", 4);
+    writer.appendWord(quint32(frames) * 2 * 16);
+    int offset = moviData + 4;
+    for (int i = 0; i < frames; ++i) {
+        writer.data().append("00dc", 4);
+        writer.appendWord(0x10); // AVIIF_KEYFRAME
+        writer.appendWord(quint32(offset - moviData));
+        writer.appendWord(videoSize);
+        offset += 8 + int(videoSize + (videoSize & 1));
+        writer.data().append("01wb", 4);
+        writer.appendWord(0);
+        writer.appendWord(quint32(offset - moviData));
+        writer.appendWord(audioSize);
+        offset += 8 + int(audioSize + (audioSize & 1));
+    }
+    writer.endList(riff);
+    return writer.data();
+}
+
+QByteArray RiffGenerator::damage(QByteArray data, int count, quint32 seed)
+{
+    // each span is as long as a chunk header, so it usually breaks one;
+    // the RIFF header itself is kept, or nothing would be scanned at all
+    constexpr int spanSize = 8;
+    if (data.size() < 12 + spanSize) {
+        return data;
+    }
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> position(12, data.size() - spanSize);
+    std::uniform_int_distribution<int> value(0, 255);
+    for (int i = 0; i < count; ++i) {
+        const int pos = position(random);
+        for (int j = 0; j < spanSize; ++j) {
+            data[pos + j] = char(value(random));
+        }
+    }
+    return data;
+}
+
+bool RiffGenerator::parseSizes(const QString &name, RiffSpec::Sizes &sizes)
+{
+    if (name == QLatin1String("fixed")) {
+        sizes = RiffSpec::Sizes::Fixed;
+    } else if (name == QLatin1String("uniform")) {
+        sizes = RiffSpec::Sizes::Uniform;
+    } else if (name == QLatin1String("exponential")) {
+        sizes = RiffSpec::Sizes::Exponential;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool RiffGenerator::save(const QByteArray &data, const QString &fileName)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
@@ -0,0 +1,44 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef RIFFGENERATOR_H
+#define RIFFGENERATOR_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+//
+// Builds synthetic RIFF files in memory for the benchmarks. Every
+// layout is deterministic for a given seed, so results can be compared
+// between commits.
+//
+
+struct RiffSpec
+{
+    enum class Sizes { Fixed, Uniform, Exponential };
+    enum class Container { Riff, Rifx, Iff };
+
+    int depth{3};        // levels of LIST chunks below the RIFF chunk
+    int fanout{8};       // children of every list
+    quint32 minSize{0};  // data size of the plain chunks
+    quint32 maxSize{64};
+    Sizes sizes{Sizes::Uniform};
+    qint64 totalSize{0}; // when not zero, subtrees are added up to this size
+    quint32 seed{1};
+    Container container{Container::Riff}; // RIFX and IFF have big endian sizes
+};
+
+class RiffGenerator
+{
+public:
+    static QByteArray tree(const RiffSpec &spec);
+    static QByteArray wide(int siblings);
+    static QByteArray avi(int frames, quint32 videoSize = 16, quint32 audioSize = 8);
+    static QByteArray damage(QByteArray data, int count, quint32 seed = 1);
+
+    static bool parseSizes(const QString &name, RiffSpec::Sizes &sizes);
+    static bool save(const QByteArray &data, const QString &fileName);
+};
+
+#endif // RIFFGENERATOR_H
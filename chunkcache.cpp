@@ -0,0 +1,193 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    chunkcache.cpp
+
+    Binary chunk index files: a fixed header followed by the raw node
+    table and the byte ranges of the lists. Indexes are memory mapped
+    when read, and the least recently used ones are removed when the
+    cache grows over its size limit.
+*/
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "chunkcache.h"
+#include "profiler.h"
+
+namespace {
+
+constexpr char Magic[4]{'R', 'T', 'I', 'X'};
+constexpr quint32 Version{3};
+constexpr qint64 HashedBytes{4096};
+
+struct IndexHeader
+{
+    char magic[4];
+    quint32 version;
+    quint64 fileSize;
+    qint64 modified; // milliseconds since the epoch
+    quint64 headerHash;
+    quint64 nodeCount;
+    quint64 listCount;
+    quint32 nodeSize;
+    quint32 reserved;
+};
+
+// FNV-1a of the first bytes of the file, catching files rewritten
+// in place with the same size and a preserved modification time
+quint64 headerHash(const uint8_t *buffer, qint64 length)
+{
+    quint64 hash = 14695981039346656037ULL;
+    const qint64 count = qMin(length, HashedBytes);
+    for (qint64 i = 0; i < count; ++i) {
+        hash = (hash ^ buffer[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+constexpr qint64 ChunkCache::DefaultLimit;
+
+ChunkCache::ChunkCache(const QString &directory, qint64 limit)
+    : m_directory(directory)
+    , m_limit(limit)
+{}
+
+QString ChunkCache::defaultDirectory()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("index");
+}
+
+QString ChunkCache::indexPath(const QString &fileName) const
+{
+    const QByteArray key = QFileInfo(fileName).canonicalFilePath().toUtf8();
+    const QByteArray digest = QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+    return QDir(m_directory).filePath(QString::fromLatin1(digest) + ".idx");
+}
+
+bool ChunkCache::load(const QString &fileName,
+                      const uint8_t *buffer,
+                      qint64 length,
+                      ChunkTable &table) const
+{
+    ProfileScope scope("cache load");
+    QFile index(indexPath(fileName));
+    if (!index.open(QIODevice::ReadOnly) || index.size() < qint64(sizeof(IndexHeader))) {
+        return false;
+    }
+    const uchar *data = index.map(0, index.size());
+    if (data == nullptr) {
+        return false;
+    }
+    IndexHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const QFileInfo info(fileName);
+    // the counts are bounded by the size of the index before they are
+    // multiplied, so that a damaged one cannot overflow the sizes
+    const quint64 available = quint64(index.size()) - sizeof(IndexHeader);
+    const bool counted = header.nodeCount <= available / sizeof(ChunkNode)
+                         && header.nodeCount <= quint64(std::numeric_limits<int32_t>::max())
+                         && header.listCount <= available / (2 * sizeof(quint64));
+    const quint64 expected = counted ? sizeof(IndexHeader) + header.nodeCount * sizeof(ChunkNode)
+                                           + header.listCount * 2 * sizeof(quint64)
+                                     : 0;
+    bool valid = counted && std::memcmp(header.magic, Magic, sizeof(Magic)) == 0 && header.version == Version
+                 && header.nodeSize == sizeof(ChunkNode) && header.fileSize == quint64(length)
+                 && header.modified == info.lastModified().toMSecsSinceEpoch()
+                 && header.headerHash == headerHash(buffer, length) && quint64(index.size()) == expected;
+    if (valid) {
+        const auto *nodes = reinterpret_cast<const ChunkNode *>(data + sizeof(IndexHeader));
+        const auto *ranges = reinterpret_cast<const uint64_t *>(nodes + header.nodeCount);
+        valid = table.restore(nodes, size_t(header.nodeCount), ranges, size_t(header.listCount), quint64(length));
+    }
+    index.unmap(const_cast<uchar *>(data));
+    if (valid) {
+        // the modification time of an index records its last use
+        index.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    } else {
+        index.close();
+        index.remove();
+    }
+    return valid;
+}
+
+bool ChunkCache::store(const QString &fileName,
+                       const uint8_t *buffer,
+                       qint64 length,
+                       const ChunkTable &table) const
+{
+    ProfileScope scope("cache store");
+    scope.setArg(0, "chunks", table.count());
+    if (!QDir().mkpath(m_directory)) {
+        return false;
+    }
+    IndexHeader header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.fileSize = quint64(length);
+    header.modified = QFileInfo(fileName).lastModified().toMSecsSinceEpoch();
+    header.headerHash = headerHash(buffer, length);
+    header.nodeCount = table.nodeCount();
+    header.listCount = table.listCount();
+    header.nodeSize = sizeof(ChunkNode);
+    header.reserved = 0;
+
+    std::vector<quint64> ranges;
+    ranges.reserve(table.listCount() * 2);
+    for (size_t i = 0; i < table.listCount(); ++i) {
+        const ListNode &list = table.listAt(i);
+        // the scan of a list that ended with a chunk cut by the end of the
+        // file went on after its declared size: nothing is left to read
+        ranges.push_back(std::min(table.resumeOffset(list), list.childrenEnd));
+        ranges.push_back(list.childrenEnd);
+    }
+
+    QSaveFile index(indexPath(fileName));
+    if (!index.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    index.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    index.write(reinterpret_cast<const char *>(table.nodeData()),
+                qint64(table.nodeCount() * sizeof(ChunkNode)));
+    index.write(reinterpret_cast<const char *>(ranges.data()),
+                qint64(ranges.size() * sizeof(quint64)));
+    if (!index.commit()) {
+        return false;
+    }
+    evict();
+    return true;
+}
+
+void ChunkCache::evict() const
+{
+    QFileInfoList indexes = QDir(m_directory).entryInfoList({"*.idx"}, QDir::Files);
+    qint64 total = 0;
+    for (const QFileInfo &info : indexes) {
+        total += info.size();
+    }
+    if (total <= m_limit) {
+        return;
+    }
+    std::sort(indexes.begin(), indexes.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() < b.lastModified();
+    });
+    for (const QFileInfo &info : indexes) {
+        if (total <= m_limit) {
+            break;
+        }
+        if (QFile::remove(info.filePath())) {
+            total -= info.size();
+        }
+    }
+}
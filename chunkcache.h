@@ -0,0 +1,41 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CHUNKCACHE_H
+#define CHUNKCACHE_H
+
+#include <QString>
+
+#include "chunktable.h"
+
+//
+// Persistent index of the chunk tables of the files opened recently, kept
+// in the user cache directory. An index is keyed by the canonical path of
+// the file, and is only used while the size, modification time and a hash
+// of the first bytes of the file match the ones recorded with it.
+//
+
+class ChunkCache
+{
+public:
+    static constexpr qint64 DefaultLimit{256 * 1024 * 1024};
+
+    explicit ChunkCache(const QString &directory = defaultDirectory(), qint64 limit = DefaultLimit);
+
+    static QString defaultDirectory();
+
+    bool load(const QString &fileName, const uint8_t *buffer, qint64 length, ChunkTable &table) const;
+    bool store(const QString &fileName,
+               const uint8_t *buffer,
+               qint64 length,
+               const ChunkTable &table) const;
+    void evict() const;
+
+private:
+    QString indexPath(const QString &fileName) const;
+
+    QString m_directory;
+    qint64 m_limit;
+};
+
+#endif // CHUNKCACHE_H
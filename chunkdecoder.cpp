@@ -0,0 +1,1001 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    chunkdecoder.cpp
+
+    Decoders of the chunks of the usual RIFF and IFF files: WAV, AVI, ANI,
+    SoundFont, AIFF and ILBM. Every decoder is a specialization of Decoder
+    for an id and a list type, and the registry is a table of them built
+    at compile time.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "chunkdecoder.h"
+#include "riff.h"
+#include "riffscanner.h"
+
+namespace {
+
+using riff::makeFourcc;
+
+// a decoder for any id or list type
+constexpr uint32_t Any{0};
+// longer texts are cut when shown
+constexpr quint64 MaxText{64 * 1024};
+
+//
+// Data of the chunks as written in the files, in the byte order of the container
+//
+
+#pragma pack(push, 1)
+struct WaveFormat
+{
+    uint16_t formatTag;
+    uint16_t channels;
+    uint32_t samplesPerSec;
+    uint32_t avgBytesPerSec;
+    uint16_t blockAlign;
+    uint16_t bitsPerSample; // PCMWAVEFORMAT and later
+    uint16_t extraSize;     // WAVEFORMATEX and later
+    uint16_t validBitsPerSample;
+    uint32_t channelMask;
+    uint8_t subFormat[16];
+};
+
+struct FactChunk
+{
+    uint32_t sampleLength;
+};
+
+struct Ds64Chunk
+{
+    uint64_t riffSize;
+    uint64_t dataSize;
+    uint64_t sampleCount;
+    uint32_t tableLength;
+};
+
+struct CuePoint
+{
+    uint32_t name;
+    uint32_t position;
+    uint32_t chunkId;
+    uint32_t chunkStart;
+    uint32_t blockStart;
+    uint32_t sampleOffset;
+};
+
+struct MainAviHeader
+{
+    uint32_t microSecPerFrame;
+    uint32_t maxBytesPerSec;
+    uint32_t paddingGranularity;
+    uint32_t flags;
+    uint32_t totalFrames;
+    uint32_t initialFrames;
+    uint32_t streams;
+    uint32_t suggestedBufferSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved[4];
+};
+
+struct AviStreamHeader
+{
+    uint32_t type;
+    uint32_t handler;
+    uint32_t flags;
+    uint16_t priority;
+    uint16_t language;
+    uint32_t initialFrames;
+    uint32_t scale;
+    uint32_t rate;
+    uint32_t start;
+    uint32_t length;
+    uint32_t suggestedBufferSize;
+    uint32_t quality;
+    uint32_t sampleSize;
+    int16_t frame[4]; // missing in some old files
+};
+
+struct OdmlHeader
+{
+    uint32_t totalFrames;
+};
+
+struct AviIndexEntry
+{
+    uint32_t chunkId;
+    uint32_t flags;
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct AniHeader
+{
+    uint32_t size;
+    uint32_t frames;
+    uint32_t steps;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bitCount;
+    uint32_t planes;
+    uint32_t displayRate;
+    uint32_t flags;
+};
+
+struct SfVersion
+{
+    uint16_t major;
+    uint16_t minor;
+};
+
+struct SfPresetHeader
+{
+    char name[20];
+    uint16_t preset;
+    uint16_t bank;
+    uint16_t bagIndex;
+    uint32_t library;
+    uint32_t genre;
+    uint32_t morphology;
+};
+
+struct SfBag
+{
+    uint16_t generatorIndex;
+    uint16_t modulatorIndex;
+};
+
+struct SfModulator
+{
+    uint16_t source;
+    uint16_t destination;
+    uint16_t amount;
+    uint16_t amountSource;
+    uint16_t transform;
+};
+
+struct SfGenerator
+{
+    uint16_t generator;
+    uint16_t amount;
+};
+
+struct SfInstrument
+{
+    char name[20];
+    uint16_t bagIndex;
+};
+
+struct SfSample
+{
+    char name[20];
+    uint32_t start;
+    uint32_t end;
+    uint32_t startLoop;
+    uint32_t endLoop;
+    uint32_t sampleRate;
+    uint8_t originalPitch;
+    int8_t pitchCorrection;
+    uint16_t sampleLink;
+    uint16_t sampleType;
+};
+
+struct AiffCommon
+{
+    uint16_t channels;
+    uint32_t sampleFrames;
+    uint16_t sampleSize;
+    uint8_t sampleRate[10]; // 80-bit IEEE 754 extended
+    uint32_t compressionType; // AIFC only
+};
+
+struct BitmapHeader
+{
+    uint16_t width;
+    uint16_t height;
+    uint16_t x;
+    uint16_t y;
+    uint8_t planes;
+    uint8_t masking;
+    uint8_t compression;
+    uint8_t pad;
+    uint16_t transparentColor;
+    uint8_t xAspect;
+    uint8_t yAspect;
+    uint16_t pageWidth;
+    uint16_t pageHeight;
+};
+#pragma pack(pop)
+
+// the records of the tables are read by index from the mapping
+static_assert(sizeof(CuePoint) == 24, "cue point size");
+static_assert(sizeof(AviIndexEntry) == 16, "idx1 entry size");
+static_assert(sizeof(SfPresetHeader) == 38, "phdr record size");
+static_assert(sizeof(SfBag) == 4, "bag record size");
+static_assert(sizeof(SfModulator) == 10, "mod record size");
+static_assert(sizeof(SfGenerator) == 4, "gen record size");
+static_assert(sizeof(SfInstrument) == 22, "inst record size");
+static_assert(sizeof(SfSample) == 46, "shdr record size");
+
+//
+// Formatting of the fields
+//
+
+QString number(quint64 value)
+{
+    return QString::number(value);
+}
+
+QString signedNumber(uint16_t value)
+{
+    return QString::number(int16_t(value));
+}
+
+QString hex(quint64 value, int digits)
+{
+    return QString("0x%1").arg(value, digits, 16, QLatin1Char('0'));
+}
+
+QString named(quint64 value, const char *name)
+{
+    return name != nullptr ? QString("%1 (%2)").arg(value).arg(QLatin1String(name)) : number(value);
+}
+
+QString fourcc(const void *field)
+{
+    return riff::fourccToQString(riff::readFourcc(field));
+}
+
+// a zero terminated string, or the whole field when it is not terminated
+QString fixedText(const char *text, quint64 size)
+{
+    const char *end = std::find(text, text + std::min(size, MaxText), '\0');
+    return QString::fromLatin1(text, int(end - text));
+}
+
+const char *formatTagName(uint16_t tag)
+{
+    switch (tag) {
+    case 0x0001:
+        return "PCM";
+    case 0x0002:
+        return "MS ADPCM";
+    case 0x0003:
+        return "IEEE float";
+    case 0x0006:
+        return "A-law";
+    case 0x0007:
+        return "mu-law";
+    case 0x0011:
+        return "IMA ADPCM";
+    case 0x0055:
+        return "MPEG Layer 3";
+    case 0xFFFE:
+        return "extensible";
+    default:
+        return nullptr;
+    }
+}
+
+// the fields of a GUID are little endian in WAV files
+QString guid(const uint8_t *bytes)
+{
+    QString text = QString("%1-%2-%3-")
+                       .arg(riff::LittleEndian::read32(bytes), 8, 16, QLatin1Char('0'))
+                       .arg(riff::LittleEndian::read16(bytes + 4), 4, 16, QLatin1Char('0'))
+                       .arg(riff::LittleEndian::read16(bytes + 6), 4, 16, QLatin1Char('0'));
+    for (int i = 8; i < 16; ++i) {
+        if (i == 10) {
+            text += QLatin1Char('-');
+        }
+        text += QString("%1").arg(bytes[i], 2, 16, QLatin1Char('0'));
+    }
+    return text;
+}
+
+// the sample rate of AIFF files, always big endian
+double extended(const uint8_t *bytes)
+{
+    const int exponent = ((bytes[0] & 0x7F) << 8 | bytes[1]) - 16383;
+    const double mantissa = double(riff::BigEndian::read64(bytes + 2));
+    const double value = std::ldexp(mantissa, exponent - 63);
+    return (bytes[0] & 0x80) ? -value : value;
+}
+
+const char *generatorName(uint16_t generator)
+{
+    static const char *const names[]{
+        "startAddrsOffset",       "endAddrsOffset",        "startloopAddrsOffset",
+        "endloopAddrsOffset",     "startAddrsCoarseOffset", "modLfoToPitch",
+        "vibLfoToPitch",          "modEnvToPitch",         "initialFilterFc",
+        "initialFilterQ",         "modLfoToFilterFc",      "modEnvToFilterFc",
+        "endAddrsCoarseOffset",   "modLfoToVolume",        "unused1",
+        "chorusEffectsSend",      "reverbEffectsSend",     "pan",
+        "unused2",                "unused3",               "unused4",
+        "delayModLFO",            "freqModLFO",            "delayVibLFO",
+        "freqVibLFO",             "delayModEnv",           "attackModEnv",
+        "holdModEnv",             "decayModEnv",           "sustainModEnv",
+        "releaseModEnv",          "keynumToModEnvHold",    "keynumToModEnvDecay",
+        "delayVolEnv",            "attackVolEnv",          "holdVolEnv",
+        "decayVolEnv",            "sustainVolEnv",         "releaseVolEnv",
+        "keynumToVolEnvHold",     "keynumToVolEnvDecay",   "instrument",
+        "reserved1",              "keyRange",              "velRange",
+        "startloopAddrsCoarseOffset", "keynum",            "velocity",
+        "initialAttenuation",     "reserved2",             "endloopAddrsCoarseOffset",
+        "coarseTune",             "fineTune",              "sampleID",
+        "sampleModes",            "reserved3",             "scaleTuning",
+        "exclusiveClass",         "overridingRootKey",     "unused5",
+        "endOper"};
+    return generator < sizeof(names) / sizeof(names[0]) ? names[generator] : nullptr;
+}
+
+// ranges are two bytes, the others a signed or unsigned word
+QString generatorAmount(uint16_t generator, const void *amount)
+{
+    const auto *bytes = static_cast<const uint8_t *>(amount);
+    switch (generator) {
+    case 43: // keyRange
+    case 44: // velRange
+        return QString("%1-%2").arg(bytes[0]).arg(bytes[1]);
+    case 41: // instrument
+    case 53: // sampleID
+        return number(riff::LittleEndian::read16(bytes));
+    default:
+        return signedNumber(riff::LittleEndian::read16(bytes));
+    }
+}
+
+QString sampleType(uint16_t type)
+{
+    QStringList names;
+    if (type & 1) {
+        names << "mono";
+    }
+    if (type & 2) {
+        names << "right";
+    }
+    if (type & 4) {
+        names << "left";
+    }
+    if (type & 8) {
+        names << "linked";
+    }
+    if (type & 0x8000) {
+        names << "ROM";
+    }
+    return QString("%1 (%2)").arg(type).arg(names.join(QLatin1Char(' ')));
+}
+
+//
+// Decoders
+//
+// A decoder names the structure and lists its fields, read in the byte
+// order of the file, calling field(name, text) for each one. The size is
+// that of the data, which is not shorter than MinSize.
+//
+
+// a structure at the start of the data, shown as a row per field
+template<typename R, uint32_t Min = sizeof(R)>
+struct Structure
+{
+    using Record = R;
+    static constexpr bool IsTable{false};
+    static constexpr uint32_t MinSize{Min};
+    static constexpr uint32_t First{0};
+};
+
+// records repeated up to the end of the data, after a header of F bytes,
+// shown as a row per record and a column per field
+template<typename R, uint32_t F = 0>
+struct Table
+{
+    using Record = R;
+    static constexpr bool IsTable{true};
+    static constexpr uint32_t MinSize{F};
+    static constexpr uint32_t First{F};
+};
+
+// zero terminated text, like the INFO strings
+struct Text : Structure<char, 1>
+{
+    static const char *name() { return "ZSTR"; }
+
+    template<typename Order, typename Field>
+    static void fields(const char &text, quint64 size, Field &&field)
+    {
+        field("text", fixedText(&text, size));
+    }
+};
+
+// no decoder for the other chunks
+template<uint32_t Id, uint32_t List = Any>
+struct Decoder;
+
+template<>
+struct Decoder<makeFourcc("fmt ")> : Structure<WaveFormat, 14>
+{
+    static const char *name() { return "WAVEFORMATEX"; }
+
+    template<typename Order, typename Field>
+    static void fields(const WaveFormat &f, quint64 size, Field &&field)
+    {
+        const uint16_t tag = Order::read16(&f.formatTag);
+        field("wFormatTag", named(tag, formatTagName(tag)));
+        field("nChannels", number(Order::read16(&f.channels)));
+        field("nSamplesPerSec", number(Order::read32(&f.samplesPerSec)));
+        field("nAvgBytesPerSec", number(Order::read32(&f.avgBytesPerSec)));
+        field("nBlockAlign", number(Order::read16(&f.blockAlign)));
+        if (size >= 16) {
+            field("wBitsPerSample", number(Order::read16(&f.bitsPerSample)));
+        }
+        if (size >= 18) {
+            field("cbSize", number(Order::read16(&f.extraSize)));
+        }
+        if (size >= sizeof(WaveFormat) && tag == 0xFFFE) {
+            field("wValidBitsPerSample", number(Order::read16(&f.validBitsPerSample)));
+            field("dwChannelMask", hex(Order::read32(&f.channelMask), 8));
+            field("SubFormat", guid(f.subFormat));
+        }
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("fact")> : Structure<FactChunk>
+{
+    static const char *name() { return "fact"; }
+
+    template<typename Order, typename Field>
+    static void fields(const FactChunk &f, quint64, Field &&field)
+    {
+        field("dwSampleLength", number(Order::read32(&f.sampleLength)));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("ds64")> : Structure<Ds64Chunk>
+{
+    static const char *name() { return "DataSize64Chunk"; }
+
+    template<typename Order, typename Field>
+    static void fields(const Ds64Chunk &d, quint64, Field &&field)
+    {
+        field("riffSize", number(Order::read64(&d.riffSize)));
+        field("dataSize", number(Order::read64(&d.dataSize)));
+        field("sampleCount", number(Order::read64(&d.sampleCount)));
+        field("tableLength", number(Order::read32(&d.tableLength)));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("cue ")> : Table<CuePoint, 4>
+{
+    static const char *name() { return "CuePoint"; }
+
+    template<typename Order, typename Field>
+    static void fields(const CuePoint &c, quint64, Field &&field)
+    {
+        field("dwName", number(Order::read32(&c.name)));
+        field("dwPosition", number(Order::read32(&c.position)));
+        field("fccChunk", fourcc(&c.chunkId));
+        field("dwChunkStart", number(Order::read32(&c.chunkStart)));
+        field("dwBlockStart", number(Order::read32(&c.blockStart)));
+        field("dwSampleOffset", number(Order::read32(&c.sampleOffset)));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("avih"), makeFourcc("hdrl")> : Structure<MainAviHeader, 40>
+{
+    static const char *name() { return "MainAVIHeader"; }
+
+    template<typename Order, typename Field>
+    static void fields(const MainAviHeader &h, quint64, Field &&field)
+    {
+        field("dwMicroSecPerFrame", number(Order::read32(&h.microSecPerFrame)));
+        field("dwMaxBytesPerSec", number(Order::read32(&h.maxBytesPerSec)));
+        field("dwPaddingGranularity", number(Order::read32(&h.paddingGranularity)));
+        field("dwFlags", hex(Order::read32(&h.flags), 8));
+        field("dwTotalFrames", number(Order::read32(&h.totalFrames)));
+        field("dwInitialFrames", number(Order::read32(&h.initialFrames)));
+        field("dwStreams", number(Order::read32(&h.streams)));
+        field("dwSuggestedBufferSize", number(Order::read32(&h.suggestedBufferSize)));
+        field("dwWidth", number(Order::read32(&h.width)));
+        field("dwHeight", number(Order::read32(&h.height)));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("strh"), makeFourcc("strl")> : Structure<AviStreamHeader, 48>
+{
+    static const char *name() { return "AVIStreamHeader"; }
+
+    template<typename Order, typename Field>
+    static void fields(const AviStreamHeader &h, quint64 size, Field &&field)
+    {
+        field("fccType", fourcc(&h.type));
+        field("fccHandler", fourcc(&h.handler));
+        field("dwFlags", hex(Order::read32(&h.flags), 8));
+        field("wPriority", number(Order::read16(&h.priority)));
+        field("wLanguage", number(Order::read16(&h.language)));
+        field("dwInitialFrames", number(Order::read32(&h.initialFrames)));
+        field("dwScale", number(Order::read32(&h.scale)));
+        field("dwRate", number(Order::read32(&h.rate)));
+        field("dwStart", number(Order::read32(&h.start)));
+        field("dwLength", number(Order::read32(&h.length)));
+        field("dwSuggestedBufferSize", number(Order::read32(&h.suggestedBufferSize)));
+        field("dwQuality", QString::number(int32_t(Order::read32(&h.quality))));
+        field("dwSampleSize", number(Order::read32(&h.sampleSize)));
+        if (size >= sizeof(AviStreamHeader)) {
+            field("rcFrame",
+                  QString("%1, %2, %3, %4")
+                      .arg(int16_t(Order::read16(&h.frame[0])))
+                      .arg(int16_t(Order::read16(&h.frame[1])))
+                      .arg(int16_t(Order::read16(&h.frame[2])))
+                      .arg(int16_t(Order::read16(&h.frame[3]))));
+        }
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("dmlh"), makeFourcc("odml")> : Structure<OdmlHeader>
+{
+    static const char *name() { return "ODMLExtendedAVIHeader"; }
+
+    template<typename Order, typename Field>
+    static void fields(const OdmlHeader &h, quint64, Field &&field)
+    {
+        field("dwTotalFrames", number(Order::read32(&h.totalFrames)));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("idx1"), makeFourcc("AVI ")> : Table<AviIndexEntry>
+{
+    static const char *name() { return "AVIINDEXENTRY"; }
+
+    template<typename Order, typename Field>
+    static void fields(const AviIndexEntry &e, quint64, Field &&field)
+    {
+        field("ckid", fourcc(&e.chunkId));
+        field("dwFlags", hex(Order::read32(&e.flags), 8));
+        field("dwChunkOffset", number(Order::read32(&e.offset)));
+        field("dwChunkLength", number(Order::read32(&e.size)));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("anih"), makeFourcc("ACON")> : Structure<AniHeader>
+{
+    static const char *name() { return "ANIHEADER"; }
+
+    template<typename Order, typename Field>
+    static void fields(const AniHeader &h, quint64, Field &&field)
+    {
+        field("cbSize", number(Order::read32(&h.size)));
+        field("nFrames", number(Order::read32(&h.frames)));
+        field("nSteps", number(Order::read32(&h.steps)));
+        field("iWidth", number(Order::read32(&h.width)));
+        field("iHeight", number(Order::read32(&h.height)));
+        field("iBitCount", number(Order::read32(&h.bitCount)));
+        field("nPlanes", number(Order::read32(&h.planes)));
+        field("iDispRate", number(Order::read32(&h.displayRate)));
+        field("bfAttributes", hex(Order::read32(&h.flags), 8));
+    }
+};
+
+// the strings of INFO lists, in WAV, AVI and SoundFont files alike
+template<>
+struct Decoder<Any, makeFourcc("INFO")> : Text
+{};
+
+struct SfVersionDecoder : Structure<SfVersion>
+{
+    static const char *name() { return "sfVersionTag"; }
+
+    template<typename Order, typename Field>
+    static void fields(const SfVersion &v, quint64, Field &&field)
+    {
+        field("wMajor", number(Order::read16(&v.major)));
+        field("wMinor", number(Order::read16(&v.minor)));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("ifil"), makeFourcc("INFO")> : SfVersionDecoder
+{};
+
+template<>
+struct Decoder<makeFourcc("iver"), makeFourcc("INFO")> : SfVersionDecoder
+{};
+
+template<>
+struct Decoder<makeFourcc("phdr"), makeFourcc("pdta")> : Table<SfPresetHeader>
+{
+    static const char *name() { return "sfPresetHeader"; }
+
+    template<typename Order, typename Field>
+    static void fields(const SfPresetHeader &p, quint64, Field &&field)
+    {
+        field("achPresetName", fixedText(p.name, sizeof(p.name)));
+        field("wPreset", number(Order::read16(&p.preset)));
+        field("wBank", number(Order::read16(&p.bank)));
+        field("wPresetBagNdx", number(Order::read16(&p.bagIndex)));
+        field("dwLibrary", number(Order::read32(&p.library)));
+        field("dwGenre", number(Order::read32(&p.genre)));
+        field("dwMorphology", number(Order::read32(&p.morphology)));
+    }
+};
+
+struct SfBagDecoder : Table<SfBag>
+{
+    static const char *name() { return "sfBag"; }
+
+    template<typename Order, typename Field>
+    static void fields(const SfBag &b, quint64, Field &&field)
+    {
+        field("wGenNdx", number(Order::read16(&b.generatorIndex)));
+        field("wModNdx", number(Order::read16(&b.modulatorIndex)));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("pbag"), makeFourcc("pdta")> : SfBagDecoder
+{};
+
+template<>
+struct Decoder<makeFourcc("ibag"), makeFourcc("pdta")> : SfBagDecoder
+{};
+
+struct SfModulatorDecoder : Table<SfModulator>
+{
+    static const char *name() { return "sfModList"; }
+
+    template<typename Order, typename Field>
+    static void fields(const SfModulator &m, quint64, Field &&field)
+    {
+        const uint16_t destination = Order::read16(&m.destination);
+        field("sfModSrcOper", hex(Order::read16(&m.source), 4));
+        field("sfModDestOper", named(destination, generatorName(destination)));
+        field("modAmount", signedNumber(Order::read16(&m.amount)));
+        field("sfModAmtSrcOper", hex(Order::read16(&m.amountSource), 4));
+        field("sfModTransOper", number(Order::read16(&m.transform)));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("pmod"), makeFourcc("pdta")> : SfModulatorDecoder
+{};
+
+template<>
+struct Decoder<makeFourcc("imod"), makeFourcc("pdta")> : SfModulatorDecoder
+{};
+
+struct SfGeneratorDecoder : Table<SfGenerator>
+{
+    static const char *name() { return "sfGenList"; }
+
+    template<typename Order, typename Field>
+    static void fields(const SfGenerator &g, quint64, Field &&field)
+    {
+        const uint16_t generator = Order::read16(&g.generator);
+        field("sfGenOper", named(generator, generatorName(generator)));
+        field("genAmount", generatorAmount(generator, &g.amount));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("pgen"), makeFourcc("pdta")> : SfGeneratorDecoder
+{};
+
+template<>
+struct Decoder<makeFourcc("igen"), makeFourcc("pdta")> : SfGeneratorDecoder
+{};
+
+template<>
+struct Decoder<makeFourcc("inst"), makeFourcc("pdta")> : Table<SfInstrument>
+{
+    static const char *name() { return "sfInst"; }
+
+    template<typename Order, typename Field>
+    static void fields(const SfInstrument &i, quint64, Field &&field)
+    {
+        field("achInstName", fixedText(i.name, sizeof(i.name)));
+        field("wInstBagNdx", number(Order::read16(&i.bagIndex)));
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("shdr"), makeFourcc("pdta")> : Table<SfSample>
+{
+    static const char *name() { return "sfSample"; }
+
+    template<typename Order, typename Field>
+    static void fields(const SfSample &s, quint64, Field &&field)
+    {
+        field("achSampleName", fixedText(s.name, sizeof(s.name)));
+        field("dwStart", number(Order::read32(&s.start)));
+        field("dwEnd", number(Order::read32(&s.end)));
+        field("dwStartloop", number(Order::read32(&s.startLoop)));
+        field("dwEndloop", number(Order::read32(&s.endLoop)));
+        field("dwSampleRate", number(Order::read32(&s.sampleRate)));
+        field("byOriginalPitch", number(s.originalPitch));
+        field("chPitchCorrection", QString::number(s.pitchCorrection));
+        field("wSampleLink", number(Order::read16(&s.sampleLink)));
+        field("sfSampleType", sampleType(Order::read16(&s.sampleType)));
+    }
+};
+
+struct AiffCommonDecoder : Structure<AiffCommon, 18>
+{
+    static const char *name() { return "CommonChunk"; }
+
+    template<typename Order, typename Field>
+    static void fields(const AiffCommon &c, quint64 size, Field &&field)
+    {
+        field("numChannels", signedNumber(Order::read16(&c.channels)));
+        field("numSampleFrames", number(Order::read32(&c.sampleFrames)));
+        field("sampleSize", signedNumber(Order::read16(&c.sampleSize)));
+        field("sampleRate", QString::number(extended(c.sampleRate)));
+        if (size >= sizeof(AiffCommon)) {
+            field("compressionType", fourcc(&c.compressionType));
+        }
+    }
+};
+
+template<>
+struct Decoder<makeFourcc("COMM"), makeFourcc("AIFF")> : AiffCommonDecoder
+{};
+
+template<>
+struct Decoder<makeFourcc("COMM"), makeFourcc("AIFC")> : AiffCommonDecoder
+{};
+
+template<>
+struct Decoder<makeFourcc("BMHD"), makeFourcc("ILBM")> : Structure<BitmapHeader>
+{
+    static const char *name() { return "BitMapHeader"; }
+
+    template<typename Order, typename Field>
+    static void fields(const BitmapHeader &b, quint64, Field &&field)
+    {
+        field("w", number(Order::read16(&b.width)));
+        field("h", number(Order::read16(&b.height)));
+        field("x", signedNumber(Order::read16(&b.x)));
+        field("y", signedNumber(Order::read16(&b.y)));
+        field("nPlanes", number(b.planes));
+        field("masking", number(b.masking));
+        field("compression", number(b.compression));
+        field("transparentColor", number(Order::read16(&b.transparentColor)));
+        field("xAspect", number(b.xAspect));
+        field("yAspect", number(b.yAspect));
+        field("pageWidth", signedNumber(Order::read16(&b.pageWidth)));
+        field("pageHeight", signedNumber(Order::read16(&b.pageHeight)));
+    }
+};
+
+// the text chunks of IFF files
+template<>
+struct Decoder<makeFourcc("NAME")> : Text
+{};
+
+template<>
+struct Decoder<makeFourcc("AUTH")> : Text
+{};
+
+template<>
+struct Decoder<makeFourcc("ANNO")> : Text
+{};
+
+template<>
+struct Decoder<makeFourcc("(c) ")> : Text
+{};
+
+//
+// Views
+//
+
+// the fields of a structure are few, they are decoded when it is selected
+template<typename D, typename Order>
+class StructureView : public ChunkView
+{
+public:
+    StructureView(const typename D::Record &record, quint64 size)
+    {
+        D::template fields<Order>(record, size, [this](const char *name, const QString &value) {
+            m_fields.emplace_back(QString::fromLatin1(name), value);
+        });
+    }
+
+    QString name() const override { return QString::fromLatin1(D::name()); }
+    bool isTable() const override { return false; }
+    QStringList columns() const override { return {QStringLiteral("Field"), QStringLiteral("Value")}; }
+    int rowCount() const override { return int(m_fields.size()); }
+
+    QString text(int row, int column) const override
+    {
+        const auto &field = m_fields[size_t(row)];
+        return column == 0 ? field.first : field.second;
+    }
+
+private:
+    std::vector<std::pair<QString, QString>> m_fields;
+};
+
+// the records of a table are decoded from the mapping as their rows are shown
+template<typename D, typename Order>
+class TableView : public ChunkView
+{
+public:
+    using Record = typename D::Record;
+
+    TableView(const Record *records, int count)
+        : m_records(records)
+        , m_count(count)
+    {
+        const Record empty{};
+        D::template fields<Order>(empty, sizeof(Record), [this](const char *name, const QString &) {
+            m_columns << QString::fromLatin1(name);
+        });
+    }
+
+    QString name() const override { return QString::fromLatin1(D::name()); }
+    bool isTable() const override { return true; }
+    QStringList columns() const override { return m_columns; }
+    int rowCount() const override { return m_count; }
+
+    // The views ask for the cells of a row one after another, and a record
+    // is decoded whole, so the last row decoded is kept for its next cells.
+    QString text(int row, int column) const override
+    {
+        if (row != m_decodedRow) {
+            m_decoded.clear();
+            D::template fields<Order>(m_records[row], sizeof(Record), [this](const char *, const QString &value) {
+                m_decoded << value;
+            });
+            m_decodedRow = row;
+        }
+        return m_decoded.value(column);
+    }
+
+private:
+    const Record *m_records;
+    int m_count;
+    QStringList m_columns;
+    mutable int m_decodedRow{-1};
+    mutable QStringList m_decoded;
+};
+
+template<typename D, typename Order>
+std::unique_ptr<ChunkView> recordView(const typename D::Record *data, quint64 size, std::false_type)
+{
+    return std::unique_ptr<ChunkView>(new StructureView<D, Order>(*data, size));
+}
+
+template<typename D, typename Order>
+std::unique_ptr<ChunkView> recordView(const typename D::Record *data, quint64 size, std::true_type)
+{
+    using Record = typename D::Record;
+    const auto *records = reinterpret_cast<const Record *>(reinterpret_cast<const uint8_t *>(data) + D::First);
+    const quint64 count = (size - D::First) / sizeof(Record);
+    return std::unique_ptr<ChunkView>(
+        new TableView<D, Order>(records, int(std::min<quint64>(count, std::numeric_limits<int>::max()))));
+}
+
+// the chunk at the header, cast to the structure of its data
+template<typename D, typename Order>
+std::unique_ptr<ChunkView> makeView(const uint8_t *header, quint64 size)
+{
+    if (size < D::MinSize) {
+        return nullptr;
+    }
+    const auto *chunk = reinterpret_cast<const riff::RiffChunk<uint8_t, Order> *>(header)
+                            ->template castTo<typename D::Record>();
+    return recordView<D, Order>(chunk->data, size, std::integral_constant<bool, D::IsTable>());
+}
+
+//
+// Registry
+//
+
+using MakeView = std::unique_ptr<ChunkView> (*)(const uint8_t *header, quint64 size);
+
+struct Entry
+{
+    uint32_t id;
+    uint32_t list;
+    MakeView little;
+    MakeView big;
+};
+
+template<typename D>
+struct Key;
+
+template<uint32_t Id, uint32_t List>
+struct Key<Decoder<Id, List>>
+{
+    static constexpr uint32_t id{Id};
+    static constexpr uint32_t list{List};
+};
+
+template<typename... Decoders>
+struct Registry
+{
+    static const Entry *find(uint32_t id, uint32_t list)
+    {
+        static constexpr Entry entries[]{{Key<Decoders>::id,
+                                          Key<Decoders>::list,
+                                          &makeView<Decoders, riff::LittleEndian>,
+                                          &makeView<Decoders, riff::BigEndian>}...};
+        for (const Entry &entry : entries) {
+            if (entry.id == id && entry.list == list) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+};
+
+using Decoders = Registry<Decoder<makeFourcc("fmt ")>,
+                          Decoder<makeFourcc("fact")>,
+                          Decoder<makeFourcc("ds64")>,
+                          Decoder<makeFourcc("cue ")>,
+                          Decoder<makeFourcc("avih"), makeFourcc("hdrl")>,
+                          Decoder<makeFourcc("strh"), makeFourcc("strl")>,
+                          Decoder<makeFourcc("dmlh"), makeFourcc("odml")>,
+                          Decoder<makeFourcc("idx1"), makeFourcc("AVI ")>,
+                          Decoder<makeFourcc("anih"), makeFourcc("ACON")>,
+                          Decoder<Any, makeFourcc("INFO")>,
+                          Decoder<makeFourcc("ifil"), makeFourcc("INFO")>,
+                          Decoder<makeFourcc("iver"), makeFourcc("INFO")>,
+                          Decoder<makeFourcc("phdr"), makeFourcc("pdta")>,
+                          Decoder<makeFourcc("pbag"), makeFourcc("pdta")>,
+                          Decoder<makeFourcc("pmod"), makeFourcc("pdta")>,
+                          Decoder<makeFourcc("pgen"), makeFourcc("pdta")>,
+                          Decoder<makeFourcc("inst"), makeFourcc("pdta")>,
+                          Decoder<makeFourcc("ibag"), makeFourcc("pdta")>,
+                          Decoder<makeFourcc("imod"), makeFourcc("pdta")>,
+                          Decoder<makeFourcc("igen"), makeFourcc("pdta")>,
+                          Decoder<makeFourcc("shdr"), makeFourcc("pdta")>,
+                          Decoder<makeFourcc("COMM"), makeFourcc("AIFF")>,
+                          Decoder<makeFourcc("COMM"), makeFourcc("AIFC")>,
+                          Decoder<makeFourcc("BMHD"), makeFourcc("ILBM")>,
+                          Decoder<makeFourcc("NAME")>,
+                          Decoder<makeFourcc("AUTH")>,
+                          Decoder<makeFourcc("ANNO")>,
+                          Decoder<makeFourcc("(c) ")>>;
+
+} // namespace
+
+std::unique_ptr<ChunkView> ChunkDecoder::view(const uint8_t *buffer, qint64 length, const ChunkTable &table,
+                                              int32_t node, bool bigEndian)
+{
+    const ChunkNode &chunk = table.node(node);
+    if (chunk.list != ChunkTable::NoNode || (chunk.flags & ChunkNode::Damaged)
+        || qint64(chunk.offset) + RiffScanner::HeaderSize > length) {
+        return nullptr;
+    }
+    // the most specific decoder: for the id in its list, for the id, or for the list
+    const uint32_t list = chunk.parent != ChunkTable::Root ? table.node(chunk.parent).listType : Any;
+    const Entry *entry = Decoders::find(chunk.fourcc, list);
+    if (entry == nullptr) {
+        entry = Decoders::find(chunk.fourcc, Any);
+    }
+    if (entry == nullptr) {
+        entry = Decoders::find(Any, list);
+    }
+    if (entry == nullptr) {
+        return nullptr;
+    }
+    // the data cut by the end of the file is not decoded
+    const quint64 size = std::min<quint64>(chunk.size,
+                                           quint64(length - qint64(chunk.offset) - RiffScanner::HeaderSize));
+    return (bigEndian ? entry->big : entry->little)(buffer + chunk.offset, size);
+}
@@ -0,0 +1,49 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CHUNKDECODER_H
+#define CHUNKDECODER_H
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <memory>
+
+#include "chunktable.h"
+
+//
+// The fields of a chunk decoded from the mapping, as a table: the fields
+// of a structure are its rows, and the records of a table like the SF2
+// presets have a row each, decoded only when they are shown.
+//
+
+class ChunkView
+{
+public:
+    virtual ~ChunkView() = default;
+
+    // the structure decoded, like WAVEFORMATEX
+    virtual QString name() const = 0;
+    // a row per record, or per field of a single structure
+    virtual bool isTable() const = 0;
+    virtual QStringList columns() const = 0;
+    virtual int rowCount() const = 0;
+    virtual QString text(int row, int column) const = 0;
+};
+
+//
+// Decoders of the known chunks, chosen by their id and the type of their
+// list. They are registered at compile time, and read the data through
+// the chunk templates of riff.h in the byte order of the file.
+//
+
+class ChunkDecoder
+{
+public:
+    // a view of the node, reading from the buffer while it lives, or
+    // nullptr when there is no decoder for it or it is too short
+    static std::unique_ptr<ChunkView> view(const uint8_t *buffer, qint64 length, const ChunkTable &table,
+                                           int32_t node, bool bigEndian);
+};
+
+#endif // CHUNKDECODER_H
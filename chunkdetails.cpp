@@ -0,0 +1,105 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QAbstractTableModel>
+#include <QHeaderView>
+#include <QLocale>
+#include <QVBoxLayout>
+#include <utility>
+
+#include "chunkdecoder.h"
+#include "chunkdetails.h"
+#include "riff.h"
+
+class ChunkViewModel : public QAbstractTableModel
+{
+public:
+    using QAbstractTableModel::QAbstractTableModel;
+
+    void setView(std::unique_ptr<ChunkView> view)
+    {
+        beginResetModel();
+        m_view = std::move(view);
+        m_columns = m_view ? m_view->columns() : QStringList();
+        endResetModel();
+    }
+
+    int rowCount(const QModelIndex &parent = {}) const override
+    {
+        return parent.isValid() || !m_view ? 0 : m_view->rowCount();
+    }
+
+    int columnCount(const QModelIndex &parent = {}) const override
+    {
+        return parent.isValid() ? 0 : m_columns.size();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (!index.isValid() || role != Qt::DisplayRole) {
+            return {};
+        }
+        return m_view->text(index.row(), index.column());
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override
+    {
+        if (role != Qt::DisplayRole) {
+            return {};
+        }
+        // the records are numbered from 0, like the indexes referring to them
+        return orientation == Qt::Horizontal ? QVariant(m_columns.value(section)) : QVariant(section);
+    }
+
+private:
+    std::unique_ptr<ChunkView> m_view;
+    QStringList m_columns;
+};
+
+ChunkDetails::ChunkDetails(QWidget *parent)
+    : QWidget(parent)
+    , m_model(new ChunkViewModel(this))
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    m_title = new QLabel(this);
+    m_title->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    mainLayout->addWidget(m_title);
+    m_fields = new QTableView(this);
+    m_fields->setModel(m_model);
+    m_fields->setWordWrap(false);
+    m_fields->setAlternatingRowColors(true);
+    // rows of a fixed height are laid out without asking for their contents
+    m_fields->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_fields->horizontalHeader()->setStretchLastSection(true);
+    mainLayout->addWidget(m_fields, 1);
+}
+
+void ChunkDetails::setChunk(const uint8_t *buffer, qint64 length, const ChunkTable &table, int32_t node,
+                            bool bigEndian)
+{
+    std::unique_ptr<ChunkView> view = ChunkDecoder::view(buffer, length, table, node, bigEndian);
+    const ChunkNode &chunk = table.node(node);
+    const QString id = riff::fourccToQString(chunk.fourcc);
+    if (!view) {
+        m_title->setText(chunk.list != ChunkTable::NoNode ? tr("%1: a list, its chunks are shown in the tree").arg(id)
+                                                          : tr("%1: no decoder for this chunk").arg(id));
+        m_model->setView(nullptr);
+        return;
+    }
+    const bool isTable = view->isTable();
+    if (isTable) {
+        m_title->setText(tr("%1: %2, %3 records").arg(id, view->name(), QLocale().toString(view->rowCount())));
+    } else {
+        m_title->setText(tr("%1: %2").arg(id, view->name()));
+    }
+    m_fields->verticalHeader()->setVisible(isTable);
+    m_model->setView(std::move(view));
+    // only the rows in view are measured
+    m_fields->resizeColumnsToContents();
+}
+
+void ChunkDetails::clear()
+{
+    m_title->clear();
+    m_model->setView(nullptr);
+}
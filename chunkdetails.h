@@ -0,0 +1,36 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CHUNKDETAILS_H
+#define CHUNKDETAILS_H
+
+#include <QLabel>
+#include <QTableView>
+#include <QWidget>
+
+#include "chunktable.h"
+
+class ChunkViewModel;
+
+//
+// The fields of the chunk selected in the tree, decoded from the mapping
+// when it is selected. The records of tables are decoded as they are
+// scrolled into view, so a table of any length is shown at once.
+//
+
+class ChunkDetails : public QWidget {
+    Q_OBJECT
+public:
+    explicit ChunkDetails(QWidget *parent = nullptr);
+
+    // the decoded fields read the buffer until another chunk is shown or cleared
+    void setChunk(const uint8_t *buffer, qint64 length, const ChunkTable &table, int32_t node, bool bigEndian);
+    void clear();
+
+private:
+    QLabel *m_title;
+    QTableView *m_fields;
+    ChunkViewModel *m_model;
+};
+
+#endif // CHUNKDETAILS_H
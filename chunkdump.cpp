@@ -0,0 +1,658 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    chunkdump.cpp
+
+    Scans RIFF files without a GUI and writes their chunk trees as an
+    indented text listing, JSON or CSV. Files are processed concurrently
+    on a thread pool, and the results are either written to one file per
+    input or aggregated in input order into a single stream.
+*/
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "chunkdump.h"
+#include "chunkhash.h"
+#include "profiler.h"
+#include "riff.h"
+#include "riffscanner.h"
+
+namespace {
+
+const QStringList KnownSuffixes{"dls", "sf2", "sf3", "avi", "wav", "rf64", "bw64", "rmi",
+                                "cdr", "ani", "pal", "webp", "aif", "aiff", "aifc", "iff"};
+
+void appendJsonString(QByteArray &output, const QByteArray &text)
+{
+    output.append('"');
+    for (char c : text) {
+        const uchar u = uchar(c);
+        if (c == '"' || c == '\\') {
+            output.append('\\');
+            output.append(c);
+        } else if (u < 0x20 || u >= 0x7f) {
+            // fourccs are Latin-1, escape anything that is not plain ASCII
+            static const char hex[] = "0123456789abcdef";
+            output.append("\\u00", 4);
+            output.append(hex[u >> 4]);
+            output.append(hex[u & 0xf]);
+        } else {
+            output.append(c);
+        }
+    }
+    output.append('"');
+}
+
+void appendCsvField(QByteArray &output, const QByteArray &text)
+{
+    if (text.indexOf(',') < 0 && text.indexOf('"') < 0 && text.indexOf('\n') < 0) {
+        output.append(text);
+        return;
+    }
+    output.append('"');
+    for (char c : text) {
+        if (c == '"') {
+            output.append('"');
+        }
+        output.append(c);
+    }
+    output.append('"');
+}
+
+QByteArray fourcc(uint32_t value)
+{
+    return QByteArray(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+QByteArray label(const ChunkNode &node)
+{
+    if (node.list != ChunkTable::NoNode) {
+        return fourcc(node.fourcc) + '(' + fourcc(node.listType) + ')';
+    }
+    return fourcc(node.fourcc);
+}
+
+// what the scanner worked around, separated by '|'
+QByteArray flagNames(uint32_t flags)
+{
+    QByteArray names;
+    const std::pair<uint32_t, const char *> known[]{{ChunkNode::Placeholder, "placeholder"},
+                                                    {ChunkNode::Overrun, "overrun"},
+                                                    {ChunkNode::Damaged, "damaged"},
+                                                    {ChunkNode::Resynced, "resynced"}};
+    for (const auto &flag : known) {
+        if (flags & flag.first) {
+            if (!names.isEmpty()) {
+                names.append('|');
+            }
+            names.append(flag.second);
+        }
+    }
+    return names;
+}
+
+QByteArray hashText(quint64 hash)
+{
+    return QByteArray::number(hash, 16).rightJustified(16, '0');
+}
+
+//
+// Depth first walk of the table in file order, with an explicit stack
+//
+
+template<typename Enter, typename Leave>
+void walk(const ChunkTable &table, Enter enter, Leave leave)
+{
+    struct Frame
+    {
+        int32_t node;
+        int32_t row;
+    };
+    std::vector<Frame> stack{{ChunkTable::Root, 0}};
+    while (!stack.empty()) {
+        Frame &top = stack.back();
+        if (top.row < table.childCount(top.node)) {
+            const int32_t child = table.child(top.node, top.row++);
+            const int depth = int(stack.size()) - 1;
+            enter(child, depth);
+            if (table.childCount(child) > 0) {
+                stack.push_back(Frame{child, 0});
+            } else {
+                leave(child, depth);
+            }
+        } else {
+            const int32_t node = top.node;
+            stack.pop_back();
+            if (node != ChunkTable::Root) {
+                leave(node, int(stack.size()) - 1);
+            }
+        }
+    }
+}
+
+struct DumpResult
+{
+    QByteArray output;
+    QString error;
+    bool done{false};
+};
+
+class DumpQueue
+{
+public:
+    explicit DumpQueue(int count)
+        : m_results(size_t(count))
+    {}
+
+    void finish(int i, QByteArray &&output, QString &&error)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_results[size_t(i)].output = std::move(output);
+        m_results[size_t(i)].error = std::move(error);
+        m_results[size_t(i)].done = true;
+        m_finished.wakeAll();
+    }
+
+    DumpResult take(int i)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_results[size_t(i)].done) {
+            m_finished.wait(&m_mutex);
+        }
+        DumpResult result = std::move(m_results[size_t(i)]);
+        m_results[size_t(i)] = DumpResult();
+        return result;
+    }
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_finished;
+    std::vector<DumpResult> m_results;
+};
+
+class DumpTask : public QRunnable
+{
+public:
+    DumpTask(DumpQueue *queue, int index, const QString &fileName, ChunkDumper::Format format, bool carve,
+             bool hash, const ChunkQuery &query, const QString &outputFile)
+        : m_queue(queue)
+        , m_index(index)
+        , m_fileName(fileName)
+        , m_format(format)
+        , m_carve(carve)
+        , m_hash(hash)
+        , m_query(query)
+        , m_outputFile(outputFile)
+    {}
+
+    void run() override
+    {
+        QByteArray output;
+        QString error;
+        if (ChunkDumper::dumpFile(m_fileName, m_format, m_carve, m_hash, m_query, output, error)
+            && !m_outputFile.isEmpty()) {
+            QFile file(m_outputFile);
+            if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                file.write(ChunkDumper::header(m_format, m_hash, !m_query.isEmpty()));
+                file.write(output);
+                file.write(ChunkDumper::footer(m_format));
+            } else {
+                error = QString("%1: %2").arg(m_outputFile, file.errorString());
+            }
+            output.clear();
+        }
+        m_queue->finish(m_index, std::move(output), std::move(error));
+    }
+
+private:
+    DumpQueue *m_queue;
+    int m_index;
+    QString m_fileName;
+    ChunkDumper::Format m_format;
+    bool m_carve;
+    bool m_hash;
+    ChunkQuery m_query;
+    QString m_outputFile;
+};
+
+} // namespace
+
+bool ChunkDumper::parseFormat(const QString &name, Format &format)
+{
+    const QString lower = name.toLower();
+    if (lower == "text" || lower == "txt") {
+        format = Format::Text;
+    } else if (lower == "json") {
+        format = Format::Json;
+    } else if (lower == "csv") {
+        format = Format::Csv;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString ChunkDumper::fileExtension(Format format)
+{
+    switch (format) {
+    case Format::Json:
+        return "json";
+    case Format::Csv:
+        return "csv";
+    default:
+        return "txt";
+    }
+}
+
+QStringList ChunkDumper::expandInputs(const QStringList &paths, QStringList *names)
+{
+    // files named explicitly are always taken, directories are searched
+    // recursively for files with the usual RIFF suffixes
+    QStringList nameFilters;
+    for (const QString &suffix : KnownSuffixes) {
+        nameFilters << "*." + suffix << "*." + suffix.toUpper();
+    }
+    QStringList files;
+    for (const QString &path : paths) {
+        if (QFileInfo(path).isDir()) {
+            QDirIterator it(path, nameFilters, QDir::Files, QDirIterator::Subdirectories);
+            QStringList found;
+            while (it.hasNext()) {
+                found << it.next();
+            }
+            found.sort();
+            files << found;
+            if (names != nullptr) {
+                const QDir directory(path);
+                for (const QString &file : found) {
+                    *names << directory.relativeFilePath(file);
+                }
+            }
+        } else {
+            files << path;
+            if (names != nullptr) {
+                *names << QFileInfo(path).fileName();
+            }
+        }
+    }
+    return files;
+}
+
+bool ChunkDumper::dumpFile(const QString &fileName, Format format, bool carve, bool hash, const ChunkQuery &query,
+                           QByteArray &output, QString &error)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("%1: %2").arg(fileName, file.errorString());
+        return false;
+    }
+    ProfileScope scope("dump file");
+    const qint64 size = file.size();
+    scope.setArg(0, "bytes", size);
+    const uint8_t *buffer = size > 0 ? file.map(0, size) : nullptr;
+    if (buffer == nullptr) {
+        error = QString("%1: %2").arg(fileName, file.errorString());
+        return false;
+    }
+    ChunkTable table;
+    {
+        ProfileScope scanScope("scan tree");
+        // the subtrees of big files are scanned on the global pool, while
+        // the files themselves are processed by the pool of run()
+        if (carve) {
+            RiffScanner::carveTree(buffer, size, table, QThreadPool::globalInstance());
+        } else {
+            RiffScanner::scanTree(buffer, size, table, QThreadPool::globalInstance());
+        }
+        scanScope.setArg(0, "chunks", table.count());
+    }
+    std::vector<int32_t> matches;
+    if (!query.isEmpty()) {
+        ProfileScope queryScope("chunk query");
+        ChunkIndex index;
+        index.update(table);
+        matches = query.run(table, index);
+        queryScope.setArg(0, "matches", qint64(matches.size()));
+    }
+    // The same data has the same hash in any file, which finds the samples
+    // or images shared by a collection of banks when the dumps are sorted.
+    std::vector<quint64> hashes;
+    if (hash && table.count() > 0) {
+        ProfileScope hashScope("hash chunks");
+        // only the chunks dumped are hashed
+        std::vector<int32_t> leaves;
+        if (query.isEmpty()) {
+            for (int32_t n = 1; n <= table.count(); ++n) {
+                if (table.node(n).list == ChunkTable::NoNode) {
+                    leaves.push_back(n);
+                }
+            }
+        } else {
+            for (const int32_t n : matches) {
+                if (table.node(n).list == ChunkTable::NoNode) {
+                    leaves.push_back(n);
+                }
+            }
+        }
+        const std::atomic<bool> cancelled{false};
+        const std::vector<quint64> leafHashes = ChunkHash::hashNodes(buffer, size, table, leaves,
+                                                                     QThreadPool::globalInstance(), cancelled);
+        hashes.assign(size_t(table.count()) + 1, 0);
+        for (size_t i = 0; i < leaves.size(); ++i) {
+            hashes[size_t(leaves[i])] = leafHashes[i];
+        }
+        hashScope.setArg(0, "chunks", qint64(leaves.size()));
+    }
+    file.unmap(const_cast<uint8_t *>(buffer));
+    if (table.count() == 0) {
+        error = carve ? QString("%1: no RIFF files found inside").arg(fileName)
+                      : QString("%1: not a valid RIFF file").arg(fileName);
+        return false;
+    }
+    ProfileScope formatScope("format");
+    if (query.isEmpty()) {
+        formatTable(table, fileName, size, format, output, hashes);
+    } else {
+        formatMatches(table, fileName, size, format, matches, output, hashes);
+    }
+    return true;
+}
+
+void ChunkDumper::formatTable(const ChunkTable &table, const QString &fileName, qint64 fileSize,
+                              Format format, QByteArray &output, const std::vector<quint64> &hashes)
+{
+    const QByteArray name = fileName.toUtf8();
+    auto hashed = [&](int32_t n) { return !hashes.empty() && table.node(n).list == ChunkTable::NoNode; };
+    switch (format) {
+    case Format::Text:
+        output.append(name).append('\n');
+        walk(
+            table,
+            [&](int32_t n, int depth) {
+                const ChunkNode &node = table.node(n);
+                output.append(QByteArray(2 * (depth + 1), ' '));
+                output.append(label(node)).append('\t');
+                output.append(QByteArray::number(quint64(node.offset))).append('\t');
+                output.append(QByteArray::number(node.size));
+                if (hashed(n)) {
+                    output.append('\t').append(hashText(hashes[size_t(n)]));
+                }
+                if (node.flags != 0) {
+                    output.append("\t[").append(flagNames(node.flags)).append(']');
+                }
+                output.append('\n');
+            },
+            [](int32_t, int) {});
+        break;
+    case Format::Csv:
+        walk(
+            table,
+            [&](int32_t n, int depth) {
+                const ChunkNode &node = table.node(n);
+                appendCsvField(output, name);
+                output.append(',').append(QByteArray::number(depth)).append(',');
+                appendCsvField(output, fourcc(node.fourcc));
+                output.append(',');
+                if (node.list != ChunkTable::NoNode) {
+                    appendCsvField(output, fourcc(node.listType));
+                }
+                output.append(',').append(QByteArray::number(quint64(node.offset)));
+                output.append(',').append(QByteArray::number(node.size));
+                output.append(',').append(flagNames(node.flags));
+                if (!hashes.empty()) {
+                    output.append(',');
+                    if (hashed(n)) {
+                        output.append(hashText(hashes[size_t(n)]));
+                    }
+                }
+                output.append('\n');
+            },
+            [](int32_t, int) {});
+        break;
+    case Format::Json: {
+        output.append("{\"file\":");
+        appendJsonString(output, name);
+        output.append(",\"size\":").append(QByteArray::number(fileSize));
+        output.append(",\"chunks\":[");
+        walk(
+            table,
+            [&](int32_t n, int) {
+                const ChunkNode &node = table.node(n);
+                if (node.row > 0) {
+                    output.append(',');
+                }
+                output.append("{\"id\":");
+                appendJsonString(output, fourcc(node.fourcc));
+                if (node.list != ChunkTable::NoNode) {
+                    output.append(",\"type\":");
+                    appendJsonString(output, fourcc(node.listType));
+                }
+                output.append(",\"offset\":").append(QByteArray::number(quint64(node.offset)));
+                output.append(",\"size\":").append(QByteArray::number(node.size));
+                if (node.flags != 0) {
+                    output.append(",\"flags\":");
+                    appendJsonString(output, flagNames(node.flags));
+                }
+                if (hashed(n)) {
+                    output.append(",\"xxh64\":");
+                    appendJsonString(output, hashText(hashes[size_t(n)]));
+                }
+                if (node.list != ChunkTable::NoNode) {
+                    output.append(",\"children\":[");
+                }
+            },
+            [&](int32_t n, int) {
+                if (table.node(n).list != ChunkTable::NoNode) {
+                    output.append(']');
+                }
+                output.append('}');
+            });
+        output.append("]}");
+        break;
+    }
+    }
+}
+
+void ChunkDumper::formatMatches(const ChunkTable &table, const QString &fileName, qint64 fileSize,
+                                Format format, const std::vector<int32_t> &nodes, QByteArray &output,
+                                const std::vector<quint64> &hashes)
+{
+    const QByteArray name = fileName.toUtf8();
+    auto hashed = [&](int32_t n) { return !hashes.empty() && table.node(n).list == ChunkTable::NoNode; };
+    ChunkLabels labels;
+    switch (format) {
+    case Format::Text:
+        output.append(name).append('\n');
+        for (const int32_t n : nodes) {
+            const ChunkNode &node = table.node(n);
+            output.append("  ").append(ChunkQuery::path(table, n, labels).toLatin1()).append('\t');
+            output.append(QByteArray::number(quint64(node.offset))).append('\t');
+            output.append(QByteArray::number(node.size));
+            if (hashed(n)) {
+                output.append('\t').append(hashText(hashes[size_t(n)]));
+            }
+            if (node.flags != 0) {
+                output.append("\t[").append(flagNames(node.flags)).append(']');
+            }
+            output.append('\n');
+        }
+        break;
+    case Format::Csv:
+        for (const int32_t n : nodes) {
+            const ChunkNode &node = table.node(n);
+            appendCsvField(output, name);
+            output.append(',');
+            appendCsvField(output, ChunkQuery::path(table, n, labels).toLatin1());
+            output.append(',').append(QByteArray::number(quint64(node.offset)));
+            output.append(',').append(QByteArray::number(node.size));
+            output.append(',').append(flagNames(node.flags));
+            if (!hashes.empty()) {
+                output.append(',');
+                if (hashed(n)) {
+                    output.append(hashText(hashes[size_t(n)]));
+                }
+            }
+            output.append('\n');
+        }
+        break;
+    case Format::Json:
+        output.append("{\"file\":");
+        appendJsonString(output, name);
+        output.append(",\"size\":").append(QByteArray::number(fileSize));
+        output.append(",\"matches\":[");
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const int32_t n = nodes[i];
+            const ChunkNode &node = table.node(n);
+            if (i > 0) {
+                output.append(',');
+            }
+            output.append("{\"path\":");
+            appendJsonString(output, ChunkQuery::path(table, n, labels).toLatin1());
+            output.append(",\"offset\":").append(QByteArray::number(quint64(node.offset)));
+            output.append(",\"size\":").append(QByteArray::number(node.size));
+            if (node.flags != 0) {
+                output.append(",\"flags\":");
+                appendJsonString(output, flagNames(node.flags));
+            }
+            if (hashed(n)) {
+                output.append(",\"xxh64\":");
+                appendJsonString(output, hashText(hashes[size_t(n)]));
+            }
+            output.append('}');
+        }
+        output.append("]}");
+        break;
+    }
+}
+
+QByteArray ChunkDumper::header(Format format, bool hash, bool query)
+{
+    switch (format) {
+    case Format::Csv:
+        if (query) {
+            return hash ? "file,path,offset,size,flags,xxh64\n" : "file,path,offset,size,flags\n";
+        }
+        return hash ? "file,depth,id,type,offset,size,flags,xxh64\n" : "file,depth,id,type,offset,size,flags\n";
+    default:
+        return {};
+    }
+}
+
+QByteArray ChunkDumper::separator(Format format)
+{
+    switch (format) {
+    case Format::Json:
+        return ",\n";
+    case Format::Text:
+        return "\n";
+    default:
+        return {};
+    }
+}
+
+QByteArray ChunkDumper::footer(Format format)
+{
+    switch (format) {
+    case Format::Json:
+        return "\n";
+    default:
+        return {};
+    }
+}
+
+int ChunkDumper::run(const QStringList &paths, Format format, int jobs, const QString &output, bool carve,
+                     bool hash, const ChunkQuery &query)
+{
+    QStringList names;
+    const QStringList files = expandInputs(paths, &names);
+    // an existing directory receives one output file per input, anything
+    // else is a single stream aggregating all the files in input order
+    const bool perFile = !output.isEmpty() && QFileInfo(output).isDir();
+    QFile stream;
+    if (perFile) {
+        // nothing to open
+    } else if (output.isEmpty()) {
+        stream.open(stdout, QIODevice::WriteOnly);
+    } else {
+        stream.setFileName(output);
+        if (!stream.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "%s: %s\n", qPrintable(output), qPrintable(stream.errorString()));
+            return 1;
+        }
+    }
+
+    DumpQueue queue(files.size());
+    QThreadPool pool;
+    if (jobs > 0) {
+        pool.setMaxThreadCount(jobs);
+    }
+    // The output files mirror the directories searched, so that the inputs
+    // of the same name in different directories do not overwrite each other.
+    // Those that still collide, like files named explicitly, are numbered.
+    QSet<QString> taken;
+    for (int i = 0; i < files.size(); ++i) {
+        QString outputFile;
+        if (perFile) {
+            const QString wanted = names.at(i) + '.' + fileExtension(format);
+            QString name = wanted;
+            for (int copy = 2; taken.contains(name.toLower()); ++copy) {
+                name = QString("%1.%2.%3").arg(names.at(i)).arg(copy).arg(fileExtension(format));
+            }
+            if (name != wanted) {
+                std::fprintf(stderr, "%s: dumped to %s, the name was taken\n", qPrintable(files.at(i)),
+                             qPrintable(name));
+            }
+            taken.insert(name.toLower());
+            outputFile = QDir(output).filePath(name);
+            QDir().mkpath(QFileInfo(outputFile).path());
+        }
+        pool.start(new DumpTask(&queue, i, files.at(i), format, carve, hash, query, outputFile));
+    }
+
+    int errors = 0;
+    bool first = true;
+    if (!perFile) {
+        stream.write(header(format, hash, !query.isEmpty()));
+        if (format == Format::Json) {
+            stream.write("[\n");
+        }
+    }
+    for (int i = 0; i < files.size(); ++i) {
+        const DumpResult result = queue.take(i);
+        if (!result.error.isEmpty()) {
+            std::fprintf(stderr, "%s\n", qPrintable(result.error));
+            ++errors;
+            continue;
+        }
+        if (!perFile) {
+            if (!first) {
+                stream.write(separator(format));
+            }
+            stream.write(result.output);
+            first = false;
+        }
+    }
+    if (!perFile) {
+        if (format == Format::Json) {
+            stream.write("\n]");
+        }
+        stream.write(footer(format));
+        stream.close();
+    }
+    pool.waitForDone();
+    return errors > 0 ? 1 : 0;
+}
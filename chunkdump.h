@@ -0,0 +1,53 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CHUNKDUMP_H
+#define CHUNKDUMP_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+#include "chunkquery.h"
+#include "chunktable.h"
+
+//
+// Headless dump of the chunk tree of RIFF files, used by the --dump
+// command line mode. No widgets are created.
+//
+
+class ChunkDumper
+{
+public:
+    enum class Format { Text, Json, Csv };
+
+    static bool parseFormat(const QString &name, Format &format);
+    static QString fileExtension(Format format);
+    // names, when given, receives the path of every file relative to the
+    // directory where it was found, or its file name when given explicitly
+    static QStringList expandInputs(const QStringList &paths, QStringList *names = nullptr);
+
+    // carving dumps the RIFF files found anywhere inside the file, hashing
+    // adds the XXH64 of the data of every chunk that is not a list, and a
+    // query that is not empty dumps only the chunks matching it
+    static bool dumpFile(const QString &fileName, Format format, bool carve, bool hash, const ChunkQuery &query,
+                         QByteArray &output, QString &error);
+    // the hashes, when given, are indexed by node
+    static void formatTable(const ChunkTable &table, const QString &fileName, qint64 fileSize,
+                            Format format, QByteArray &output,
+                            const std::vector<quint64> &hashes = std::vector<quint64>());
+    // the nodes matching a query with their paths, instead of the tree
+    static void formatMatches(const ChunkTable &table, const QString &fileName, qint64 fileSize,
+                              Format format, const std::vector<int32_t> &nodes, QByteArray &output,
+                              const std::vector<quint64> &hashes = std::vector<quint64>());
+
+    static QByteArray header(Format format, bool hash = false, bool query = false);
+    static QByteArray separator(Format format);
+    static QByteArray footer(Format format);
+
+    static int run(const QStringList &paths, Format format, int jobs, const QString &output, bool carve = false,
+                   bool hash = false, const ChunkQuery &query = ChunkQuery());
+};
+
+#endif // CHUNKDUMP_H
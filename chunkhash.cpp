@@ -0,0 +1,357 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    chunkhash.cpp
+
+    XXH64 and CRC-32 of the chunk payloads of a memory mapped file.
+*/
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QtEndian>
+#include <cstring>
+
+#include "chunkhash.h"
+#include "profiler.h"
+#include "riffscanner.h"
+
+namespace {
+// Payloads are hashed in blocks of this size between checks of the
+// cancel flag, and the nodes are hashed by tasks of about this many bytes
+// or this many nodes, whichever comes first.
+constexpr qint64 HashBlockSize{1 << 20};
+constexpr qint64 BatchBytes{32 << 20};
+constexpr size_t BatchNodes{4096};
+
+constexpr quint64 Prime1{0x9E3779B185EBCA87ULL};
+constexpr quint64 Prime2{0xC2B2AE3D27D4EB4FULL};
+constexpr quint64 Prime3{0x165667B19E3779F9ULL};
+constexpr quint64 Prime4{0x85EBCA77C2B2AE63ULL};
+constexpr quint64 Prime5{0x27D4EB2F165667C5ULL};
+
+inline quint64 rotl(quint64 x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+inline quint64 read64(const uint8_t *p)
+{
+    return qFromLittleEndian<quint64>(p);
+}
+
+inline quint32 read32(const uint8_t *p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+inline quint64 round(quint64 lane, quint64 input)
+{
+    return rotl(lane + input * Prime2, 31) * Prime1;
+}
+
+inline quint64 mergeRound(quint64 hash, quint64 lane)
+{
+    return (hash ^ round(0, lane)) * Prime1 + Prime4;
+}
+
+// the reflected polynomial of zlib, eight tables to read 8 bytes at a time
+struct Crc32Tables
+{
+    quint32 table[8][256];
+
+    Crc32Tables()
+    {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+            }
+            table[0][i] = crc;
+        }
+        for (int k = 1; k < 8; ++k) {
+            for (int i = 0; i < 256; ++i) {
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+const Crc32Tables &crc32Tables()
+{
+    static const Crc32Tables tables;
+    return tables;
+}
+
+class HashBatch : public QRunnable
+{
+public:
+    HashBatch(const uint8_t *buffer, qint64 length, const ChunkTable &table, const int32_t *nodes, quint64 *hashes,
+              size_t count, const std::atomic<bool> &cancelled, QSemaphore *done)
+        : m_buffer(buffer)
+        , m_length(length)
+        , m_table(table)
+        , m_nodes(nodes)
+        , m_hashes(hashes)
+        , m_count(count)
+        , m_cancelled(cancelled)
+        , m_done(done)
+    {}
+
+    void run() override
+    {
+        ProfileScope scope("hash chunks");
+        scope.setArg(0, "chunks", qint64(m_count));
+        for (size_t i = 0; i < m_count; ++i) {
+            const ChunkNode &node = m_table.node(m_nodes[i]);
+            if (!ChunkHash::hashPayload(ChunkHash::Xxh64Hash, m_buffer + ChunkHash::payloadOffset(node),
+                                        ChunkHash::payloadLength(node, m_length), m_cancelled, m_hashes[i])) {
+                break;
+            }
+        }
+        if (m_done != nullptr) {
+            m_done->release();
+        }
+    }
+
+private:
+    const uint8_t *m_buffer;
+    qint64 m_length;
+    const ChunkTable &m_table;
+    const int32_t *m_nodes;
+    quint64 *m_hashes;
+    size_t m_count;
+    const std::atomic<bool> &m_cancelled;
+    QSemaphore *m_done;
+};
+} // namespace
+
+Xxh64::Xxh64(quint64 seed)
+    : m_lanes{seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1}
+    , m_seed(seed)
+{}
+
+void Xxh64::update(const uint8_t *data, size_t length)
+{
+    m_total += length;
+    if (m_pendingSize + length < sizeof(m_pending)) {
+        std::memcpy(m_pending + m_pendingSize, data, length);
+        m_pendingSize += length;
+        return;
+    }
+    quint64 v1 = m_lanes[0];
+    quint64 v2 = m_lanes[1];
+    quint64 v3 = m_lanes[2];
+    quint64 v4 = m_lanes[3];
+    if (m_pendingSize > 0) {
+        const size_t fill = sizeof(m_pending) - m_pendingSize;
+        std::memcpy(m_pending + m_pendingSize, data, fill);
+        v1 = round(v1, read64(m_pending));
+        v2 = round(v2, read64(m_pending + 8));
+        v3 = round(v3, read64(m_pending + 16));
+        v4 = round(v4, read64(m_pending + 24));
+        data += fill;
+        length -= fill;
+        m_pendingSize = 0;
+    }
+    for (; length >= 32; data += 32, length -= 32) {
+        v1 = round(v1, read64(data));
+        v2 = round(v2, read64(data + 8));
+        v3 = round(v3, read64(data + 16));
+        v4 = round(v4, read64(data + 24));
+    }
+    m_lanes[0] = v1;
+    m_lanes[1] = v2;
+    m_lanes[2] = v3;
+    m_lanes[3] = v4;
+    std::memcpy(m_pending, data, length);
+    m_pendingSize = length;
+}
+
+quint64 Xxh64::digest() const
+{
+    quint64 hash;
+    if (m_total >= sizeof(m_pending)) {
+        hash = rotl(m_lanes[0], 1) + rotl(m_lanes[1], 7) + rotl(m_lanes[2], 12) + rotl(m_lanes[3], 18);
+        for (const quint64 lane : m_lanes) {
+            hash = mergeRound(hash, lane);
+        }
+    } else {
+        hash = m_seed + Prime5;
+    }
+    hash += m_total;
+    const uint8_t *p = m_pending;
+    const uint8_t *end = m_pending + m_pendingSize;
+    for (; p + 8 <= end; p += 8) {
+        hash = rotl(hash ^ round(0, read64(p)), 27) * Prime1 + Prime4;
+    }
+    if (p + 4 <= end) {
+        hash = rotl(hash ^ (quint64(read32(p)) * Prime1), 23) * Prime2 + Prime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        hash = rotl(hash ^ (*p * Prime5), 11) * Prime1;
+    }
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+void Crc32::update(const uint8_t *data, size_t length)
+{
+    const auto &t = crc32Tables().table;
+    quint32 crc = m_crc;
+    for (; length >= 8; data += 8, length -= 8) {
+        const quint32 one = read32(data) ^ crc;
+        const quint32 two = read32(data + 4);
+        crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24]
+              ^ t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+    }
+    for (; length > 0; ++data, --length) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xFF];
+    }
+    m_crc = crc;
+}
+
+qint64 ChunkHash::payloadOffset(const ChunkNode &node)
+{
+    return qint64(node.offset) + RiffScanner::HeaderSize;
+}
+
+qint64 ChunkHash::payloadLength(const ChunkNode &node, qint64 bufferLength)
+{
+    return qBound(qint64(0), bufferLength - payloadOffset(node), qint64(node.size));
+}
+
+bool ChunkHash::hashPayload(Kind kind, const uint8_t *data, qint64 length, const std::atomic<bool> &cancelled,
+                            quint64 &hash)
+{
+    Xxh64 xxh64;
+    Crc32 crc32;
+    for (qint64 done = 0; done < length; done += HashBlockSize) {
+        if (cancelled.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        const size_t block = size_t(qMin(HashBlockSize, length - done));
+        if (kind == Crc32Hash) {
+            crc32.update(data + done, block);
+        } else {
+            xxh64.update(data + done, block);
+        }
+    }
+    hash = kind == Crc32Hash ? crc32.value() : xxh64.digest();
+    return true;
+}
+
+std::vector<quint64> ChunkHash::hashNodes(const uint8_t *buffer, qint64 length, const ChunkTable &table,
+                                          const std::vector<int32_t> &nodes, QThreadPool *pool,
+                                          const std::atomic<bool> &cancelled)
+{
+    std::vector<quint64> hashes(nodes.size(), 0);
+    if (pool == nullptr) {
+        HashBatch(buffer, length, table, nodes.data(), hashes.data(), nodes.size(), cancelled, nullptr).run();
+        return hashes;
+    }
+    QSemaphore done;
+    int batches = 0;
+    for (size_t first = 0; first < nodes.size();) {
+        size_t last = first;
+        qint64 bytes = 0;
+        while (last < nodes.size() && last - first < BatchNodes && bytes < BatchBytes) {
+            bytes += qint64(table.node(nodes[last]).size);
+            ++last;
+        }
+        pool->start(new HashBatch(buffer, length, table, nodes.data() + first, hashes.data() + first,
+                                  last - first, cancelled, &done));
+        ++batches;
+        first = last;
+    }
+    done.acquire(batches);
+    return hashes;
+}
+
+class ChunkHasher::Task : public QRunnable
+{
+public:
+    Task(ChunkHasher *hasher, int generation, int node, ChunkHash::Kind kind, const uint8_t *data, qint64 length)
+        : m_hasher(hasher)
+        , m_generation(generation)
+        , m_node(node)
+        , m_kind(kind)
+        , m_data(data)
+        , m_length(length)
+    {}
+
+    void run() override
+    {
+        ProfileScope scope("hash chunk");
+        scope.setArg(0, "bytes", m_length);
+        quint64 hash = 0;
+        if (!ChunkHash::hashPayload(m_kind, m_data, m_length, m_hasher->m_cancelled, hash)) {
+            return;
+        }
+        ChunkHasher *hasher = m_hasher;
+        const int generation = m_generation;
+        const int node = m_node;
+        const int kind = m_kind;
+        QMetaObject::invokeMethod(
+            hasher,
+            [=] { hasher->taskDone(generation, node, kind, hash); },
+            Qt::QueuedConnection);
+    }
+
+private:
+    ChunkHasher *m_hasher;
+    int m_generation;
+    int m_node;
+    ChunkHash::Kind m_kind;
+    const uint8_t *m_data;
+    qint64 m_length;
+};
+
+ChunkHasher::ChunkHasher(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+ChunkHasher::~ChunkHasher()
+{
+    cancel();
+}
+
+void ChunkHasher::setBuffer(const uint8_t *buffer, qint64 length)
+{
+    cancel();
+    m_buffer = buffer;
+    m_length = length;
+}
+
+void ChunkHasher::request(int32_t node, ChunkHash::Kind kind, qint64 offset, qint64 length)
+{
+    if (m_buffer == nullptr || offset < 0 || offset + length > m_length) {
+        return;
+    }
+    m_pool.start(new Task(this, m_generation, node, kind, m_buffer + offset, length));
+}
+
+void ChunkHasher::cancel()
+{
+    // the hashes still queued for the GUI thread are ignored
+    ++m_generation;
+    m_cancelled = true;
+    m_pool.clear();
+    m_pool.waitForDone();
+    m_cancelled = false;
+}
+
+void ChunkHasher::taskDone(int generation, int node, int kind, quint64 hash)
+{
+    if (generation == m_generation) {
+        emit hashed(node, kind, hash);
+    }
+}
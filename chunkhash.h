@@ -0,0 +1,104 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CHUNKHASH_H
+#define CHUNKHASH_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "chunktable.h"
+
+//
+// Content hashes of the chunk payloads, used to find the chunks holding
+// the same data: XXH64 (the 64-bit xxHash algorithm) to compare them, and
+// the CRC-32 of zip and PNG files to check them against other tools.
+//
+
+class Xxh64
+{
+public:
+    explicit Xxh64(quint64 seed = 0);
+
+    void update(const uint8_t *data, size_t length);
+    quint64 digest() const;
+
+private:
+    // four independent lanes of 8 bytes, which the compiler interleaves
+    quint64 m_lanes[4];
+    uint8_t m_pending[32];
+    size_t m_pendingSize{0};
+    quint64 m_total{0};
+    quint64 m_seed;
+};
+
+class Crc32
+{
+public:
+    void update(const uint8_t *data, size_t length);
+    quint32 value() const { return ~m_crc; }
+
+private:
+    quint32 m_crc{0xFFFFFFFF};
+};
+
+class ChunkHash
+{
+public:
+    enum Kind { Xxh64Hash, Crc32Hash };
+
+    // the bytes after the chunk header, up to its size or the end of the buffer
+    static qint64 payloadOffset(const ChunkNode &node);
+    static qint64 payloadLength(const ChunkNode &node, qint64 bufferLength);
+
+    // Hashes a block at a time, giving up as soon as cancelled is set, so
+    // that closing a file does not wait for a payload of several GiB.
+    static bool hashPayload(Kind kind, const uint8_t *data, qint64 length, const std::atomic<bool> &cancelled,
+                            quint64 &hash);
+
+    // the XXH64 of the payloads of the given nodes, in parallel on the
+    // pool; the hashes are left at zero when cancelled
+    static std::vector<quint64> hashNodes(const uint8_t *buffer, qint64 length, const ChunkTable &table,
+                                          const std::vector<int32_t> &nodes, QThreadPool *pool,
+                                          const std::atomic<bool> &cancelled);
+};
+
+//
+// Hashes the payloads requested by the tree view in the background, on a
+// pool of its own, publishing each hash as it is done. A payload of
+// several GiB takes a thread for a while, but never the GUI thread.
+//
+
+class ChunkHasher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ChunkHasher(QObject *parent = nullptr);
+    ~ChunkHasher() override;
+
+    void setBuffer(const uint8_t *buffer, qint64 length);
+    void request(int32_t node, ChunkHash::Kind kind, qint64 offset, qint64 length);
+    // drops the requests, waiting for the payloads being hashed to stop
+    void cancel();
+
+signals:
+    void hashed(int node, int kind, quint64 hash);
+
+private:
+    class Task;
+    void taskDone(int generation, int node, int kind, quint64 hash);
+
+    const uint8_t *m_buffer{nullptr};
+    qint64 m_length{0};
+    QThreadPool m_pool;
+    std::atomic<bool> m_cancelled{false};
+    int m_generation{0};
+};
+
+#endif // CHUNKHASH_H
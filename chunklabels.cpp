@@ -0,0 +1,43 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "chunklabels.h"
+#include "riff.h"
+
+constexpr int ChunkLabels::MaxLabels;
+
+void ChunkLabels::clear()
+{
+    m_ids.clear();
+    m_lists.clear();
+}
+
+QString ChunkLabels::id(uint32_t fourcc)
+{
+    const auto found = m_ids.constFind(fourcc);
+    if (found != m_ids.constEnd()) {
+        return found.value();
+    }
+    const QString text = riff::fourccToQString(fourcc);
+    if (m_ids.size() < MaxLabels) {
+        m_ids.insert(fourcc, text);
+    }
+    return text;
+}
+
+QString ChunkLabels::label(const ChunkNode &node)
+{
+    if (node.list == ChunkTable::NoNode) {
+        return id(node.fourcc);
+    }
+    const quint64 key = quint64(node.fourcc) << 32 | node.listType;
+    const auto found = m_lists.constFind(key);
+    if (found != m_lists.constEnd()) {
+        return found.value();
+    }
+    const QString text = QString("%1(%2)").arg(id(node.fourcc), id(node.listType));
+    if (m_lists.size() < MaxLabels) {
+        m_lists.insert(key, text);
+    }
+    return text;
+}
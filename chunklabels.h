@@ -0,0 +1,38 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CHUNKLABELS_H
+#define CHUNKLABELS_H
+
+#include <QHash>
+#include <QString>
+#include <QtGlobal>
+#include <cstdint>
+
+#include "chunktable.h"
+
+//
+// The labels of the chunks, like "fmt " or "LIST(INFO)", formatted once
+// per distinct id and list type. Files repeat a handful of ids many times,
+// so rows share the strings of the cache instead of building their own.
+// Damaged chunks and carved garbage may have any bytes as an id, so the
+// cache stops growing at MaxLabels and formats the rest every time.
+// Not thread safe: each view or job owns its own.
+//
+
+class ChunkLabels
+{
+public:
+    static constexpr int MaxLabels{4096};
+
+    void clear();
+    QString id(uint32_t fourcc);
+    // the id, followed by the list type in parentheses for lists
+    QString label(const ChunkNode &node);
+
+private:
+    QHash<uint32_t, QString> m_ids;
+    QHash<quint64, QString> m_lists;
+};
+
+#endif // CHUNKLABELS_H
@@ -0,0 +1,299 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    chunkquery.cpp
+
+    Finds the chunks matching a path expression through an index of the
+    nodes by id, checking the ancestors of the candidates only.
+*/
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <algorithm>
+#include <cstring>
+
+#include "chunkquery.h"
+
+namespace {
+const std::vector<int32_t> NoNodes;
+
+quint64 listKey(uint32_t fourcc, uint32_t listType)
+{
+    return quint64(fourcc) << 32 | listType;
+}
+
+// one to four Latin-1 characters, padded with spaces
+bool parseFourcc(const QString &text, uint32_t &fourcc)
+{
+    if (text.isEmpty() || text.size() > 4) {
+        return false;
+    }
+    char bytes[4]{' ', ' ', ' ', ' '};
+    for (int i = 0; i < text.size(); ++i) {
+        if (text.at(i).unicode() > 0xFF) {
+            return false;
+        }
+        bytes[i] = char(text.at(i).unicode());
+    }
+    std::memcpy(&fourcc, bytes, sizeof(fourcc));
+    return true;
+}
+} // namespace
+
+constexpr int ChunkQuery::MaxResults;
+
+void ChunkIndex::clear()
+{
+    m_indexed = 0;
+    m_ids.clear();
+    m_lists.clear();
+}
+
+void ChunkIndex::update(const ChunkTable &table)
+{
+    for (int32_t n = m_indexed + 1; n <= table.count(); ++n) {
+        const ChunkNode &node = table.node(n);
+        if (node.flags & ChunkNode::Damaged) {
+            continue;
+        }
+        m_ids[node.fourcc].push_back(n);
+        if (node.list != ChunkTable::NoNode) {
+            m_lists[listKey(node.fourcc, node.listType)].push_back(n);
+        }
+    }
+    m_indexed = table.count();
+}
+
+const std::vector<int32_t> &ChunkIndex::byId(uint32_t fourcc) const
+{
+    const auto found = m_ids.find(fourcc);
+    return found != m_ids.end() ? found->second : NoNodes;
+}
+
+const std::vector<int32_t> &ChunkIndex::byList(uint32_t fourcc, uint32_t listType) const
+{
+    const auto found = m_lists.find(listKey(fourcc, listType));
+    return found != m_lists.end() ? found->second : NoNodes;
+}
+
+std::vector<int32_t> ChunkIndex::byListType(uint32_t listType) const
+{
+    // a handful of list ids share each type, like RIFF and LIST
+    std::vector<int32_t> nodes;
+    for (const auto &list : m_lists) {
+        if (uint32_t(list.first) == listType) {
+            nodes.insert(nodes.end(), list.second.begin(), list.second.end());
+        }
+    }
+    return nodes;
+}
+
+bool ChunkQuery::parse(const QString &text, ChunkQuery &query, QString &error)
+{
+    query.m_steps.clear();
+    const QString trimmed = text.trimmed();
+    if (trimmed.isEmpty()) {
+        error = QCoreApplication::translate("ChunkQuery", "the query is empty");
+        return false;
+    }
+    // relative paths are found at any depth
+    bool descendant = true;
+    int pos = 0;
+    if (trimmed.startsWith(QLatin1String("//"))) {
+        pos = 2;
+    } else if (trimmed.startsWith(QLatin1Char('/'))) {
+        descendant = false;
+        pos = 1;
+    }
+    for (;;) {
+        const int next = trimmed.indexOf(QLatin1Char('/'), pos);
+        const QString token = trimmed.mid(pos, next < 0 ? -1 : next - pos);
+        Step step{descendant, false, 0, false, false, 0};
+        QString id = token;
+        const int open = token.indexOf(QLatin1Char('('));
+        if (open >= 0) {
+            if (!token.endsWith(QLatin1Char(')'))) {
+                error = QCoreApplication::translate("ChunkQuery", "missing ')' in \"%1\"").arg(token);
+                return false;
+            }
+            id = token.left(open);
+            const QString type = token.mid(open + 1, token.size() - open - 2);
+            step.isList = true;
+            step.anyType = type == QLatin1String("*");
+            if (!step.anyType && !parseFourcc(type, step.listType)) {
+                error = QCoreApplication::translate("ChunkQuery", "\"%1\" is not a list type").arg(type);
+                return false;
+            }
+        }
+        step.anyId = id == QLatin1String("*");
+        if (!step.anyId && !parseFourcc(id, step.fourcc)) {
+            if (token.isEmpty()) {
+                error = QCoreApplication::translate("ChunkQuery", "empty step at %1").arg(pos);
+            } else if (id.isEmpty()) {
+                error = QCoreApplication::translate("ChunkQuery", "missing chunk id in \"%1\"").arg(token);
+            } else {
+                error = QCoreApplication::translate("ChunkQuery", "\"%1\" is not a chunk id").arg(id);
+            }
+            return false;
+        }
+        query.m_steps.push_back(step);
+        if (next < 0) {
+            break;
+        }
+        descendant = next + 1 < trimmed.size() && trimmed.at(next + 1) == QLatin1Char('/');
+        pos = next + (descendant ? 2 : 1);
+    }
+    return true;
+}
+
+bool ChunkQuery::isEmpty() const
+{
+    return m_steps.empty();
+}
+
+bool ChunkQuery::matchesStep(const ChunkNode &node, const Step &step)
+{
+    if (node.flags & ChunkNode::Damaged) {
+        return false;
+    }
+    if (!step.anyId && node.fourcc != step.fourcc) {
+        return false;
+    }
+    if (step.isList) {
+        return node.list != ChunkTable::NoNode && (step.anyType || node.listType == step.listType);
+    }
+    return true;
+}
+
+// the first step of the run of '/' steps ending at the given one
+int ChunkQuery::runStart(int step) const
+{
+    while (step > 0 && !m_steps[size_t(step)].descendant) {
+        --step;
+    }
+    return step;
+}
+
+// the node matching the first step of a run, when the node and its
+// ancestors match the steps first..last from the bottom up
+int32_t ChunkQuery::matchRun(const ChunkTable &table, int32_t node, int first, int last) const
+{
+    for (int step = last;; --step) {
+        if (node == ChunkTable::Root || !matchesStep(table.node(node), m_steps[size_t(step)])) {
+            return ChunkTable::NoNode;
+        }
+        if (step == first) {
+            return node;
+        }
+        node = table.node(node).parent;
+    }
+}
+
+// Whether the node matches the step, with ancestors matching the steps
+// before. The runs of '/' steps are matched from the node up, each one at
+// the nearest ancestor where it matches: the lower a run matches, the more
+// ancestors are left to the runs above, so no other choice needs to be
+// tried and the ancestors are walked once instead of once per path.
+bool ChunkQuery::matches(const ChunkTable &table, int32_t node, int step) const
+{
+    int first = runStart(step);
+    int32_t top = matchRun(table, node, first, step);
+    while (top != ChunkTable::NoNode && first > 0) {
+        const int last = first - 1;
+        first = runStart(last);
+        // a path from the top level has its first run at a fixed depth
+        const bool anchored = first == 0 && !m_steps[0].descendant;
+        int32_t found = ChunkTable::NoNode;
+        for (int32_t p = table.node(top).parent; p != ChunkTable::Root && found == ChunkTable::NoNode;
+             p = table.node(p).parent) {
+            found = matchRun(table, p, first, last);
+            if (anchored && found != ChunkTable::NoNode && table.node(found).parent != ChunkTable::Root) {
+                found = ChunkTable::NoNode;
+            }
+        }
+        top = found;
+    }
+    return top != ChunkTable::NoNode && (m_steps[0].descendant || table.node(top).parent == ChunkTable::Root);
+}
+
+// the nodes that may match a step with an id or a list type
+std::vector<int32_t> ChunkQuery::candidates(const ChunkIndex &index, int step) const
+{
+    const Step &s = m_steps[size_t(step)];
+    if (!s.anyId) {
+        return s.isList && !s.anyType ? index.byList(s.fourcc, s.listType) : index.byId(s.fourcc);
+    }
+    return index.byListType(s.listType);
+}
+
+std::vector<int32_t> ChunkQuery::run(const ChunkTable &table, const ChunkIndex &index) const
+{
+    std::vector<int32_t> nodes;
+    if (m_steps.empty()) {
+        return nodes;
+    }
+    const int last = int(m_steps.size()) - 1;
+    // the last step the index can answer, the steps after it match any chunk
+    int anchor = last;
+    while (anchor >= 0 && m_steps[size_t(anchor)].anyId
+           && (!m_steps[size_t(anchor)].isList || m_steps[size_t(anchor)].anyType)) {
+        --anchor;
+    }
+    if (anchor < 0) {
+        // only wildcards, like /*/*: the shape of the tree is all there is to check
+        for (int32_t n = 1; n <= table.count(); ++n) {
+            if (matches(table, n, last)) {
+                nodes.push_back(n);
+            }
+        }
+    } else {
+        for (const int32_t n : candidates(index, anchor)) {
+            if (matches(table, n, anchor)) {
+                nodes.push_back(n);
+            }
+        }
+        for (int step = anchor + 1; step <= last; ++step) {
+            const Step &s = m_steps[size_t(step)];
+            std::vector<int32_t> next;
+            std::vector<int32_t> stack;
+            for (const int32_t n : nodes) {
+                stack.assign(1, n);
+                while (!stack.empty()) {
+                    const int32_t parent = stack.back();
+                    stack.pop_back();
+                    for (int32_t row = 0; row < table.childCount(parent); ++row) {
+                        const int32_t child = table.child(parent, row);
+                        if (matchesStep(table.node(child), s)) {
+                            next.push_back(child);
+                        }
+                        if (s.descendant) {
+                            stack.push_back(child);
+                        }
+                    }
+                }
+            }
+            // the descendants of nested matches are found more than once
+            if (s.descendant) {
+                std::sort(next.begin(), next.end());
+                next.erase(std::unique(next.begin(), next.end()), next.end());
+            }
+            nodes.swap(next);
+        }
+    }
+    std::sort(nodes.begin(), nodes.end(), [&](int32_t a, int32_t b) {
+        const ChunkNode &nodeA = table.node(a);
+        const ChunkNode &nodeB = table.node(b);
+        return nodeA.offset < nodeB.offset || (nodeA.offset == nodeB.offset && a < b);
+    });
+    return nodes;
+}
+
+QString ChunkQuery::path(const ChunkTable &table, int32_t node, ChunkLabels &labels)
+{
+    QStringList steps;
+    for (int32_t n = node; n != ChunkTable::Root; n = table.node(n).parent) {
+        steps.prepend(labels.label(table.node(n)));
+    }
+    return steps.join(QLatin1Char('/'));
+}
@@ -0,0 +1,91 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CHUNKQUERY_H
+#define CHUNKQUERY_H
+
+#include <QString>
+#include <QtGlobal>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "chunklabels.h"
+#include "chunktable.h"
+
+//
+// The nodes of a table by chunk id, and the lists by id and list type.
+// Nodes are only ever appended to a table, so the index catches up with
+// the nodes added since the last update, as the scan goes on. Damaged
+// chunks are not indexed, their ids are whatever bytes were skipped.
+//
+
+class ChunkIndex
+{
+public:
+    void clear();
+    void update(const ChunkTable &table);
+
+    const std::vector<int32_t> &byId(uint32_t fourcc) const;
+    const std::vector<int32_t> &byList(uint32_t fourcc, uint32_t listType) const;
+    // the lists of a type, whatever their id
+    std::vector<int32_t> byListType(uint32_t listType) const;
+
+private:
+    int32_t m_indexed{0};
+    std::unordered_map<uint32_t, std::vector<int32_t>> m_ids;
+    std::unordered_map<quint64, std::vector<int32_t>> m_lists;
+};
+
+//
+// Path expressions over the chunk tree, like the ones of XPath:
+//
+//   RIFF(AVI )/LIST(hdrl)/LIST(strl)/strh   a path from the top level
+//   /RIFF(WAVE)/data                        the same, starting with '/'
+//   //LIST(INFO)/*                          every child of every INFO list
+//   strf                                    a relative path, found at any depth
+//
+// A step is an id, '*' for any chunk, or a list as id(type), where either
+// may be '*'. Ids shorter than four characters are padded with spaces.
+// '/' takes the children of the previous step and '//' its descendants.
+// The candidates come from the index for the last step with an id, and
+// only their ancestors are checked, so that the tree is never walked but
+// below the chunks matching that step when the steps after it are '*'.
+//
+
+class ChunkQuery
+{
+public:
+    // the results shown by the GUI; the command line lists them all
+    static constexpr int MaxResults{100000};
+
+    static bool parse(const QString &text, ChunkQuery &query, QString &error);
+
+    bool isEmpty() const;
+    // the nodes matching, in file order
+    std::vector<int32_t> run(const ChunkTable &table, const ChunkIndex &index) const;
+
+    // the steps from the top level down to the node, like RIFF(AVI )/LIST(hdrl)/avih
+    static QString path(const ChunkTable &table, int32_t node, ChunkLabels &labels);
+
+private:
+    struct Step
+    {
+        bool descendant; // '//' before the step, or a relative first step
+        bool anyId;
+        uint32_t fourcc;
+        bool isList; // the step has a list type, only lists match
+        bool anyType;
+        uint32_t listType;
+    };
+
+    static bool matchesStep(const ChunkNode &node, const Step &step);
+    int runStart(int step) const;
+    int32_t matchRun(const ChunkTable &table, int32_t node, int first, int last) const;
+    bool matches(const ChunkTable &table, int32_t node, int step) const;
+    std::vector<int32_t> candidates(const ChunkIndex &index, int step) const;
+
+    std::vector<Step> m_steps;
+};
+
+#endif // CHUNKQUERY_H
@@ -0,0 +1,145 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    chunkstats.cpp
+
+    Counts the chunks of a table by kind, in slices of nodes on a thread pool.
+*/
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
+#include <unordered_map>
+
+#include "chunkstats.h"
+#include "profiler.h"
+#include "riffscanner.h"
+
+namespace {
+// Nodes counted by one task: the per kind maps of every slice are merged
+// at the end, so a few dozen slices are enough to keep all cores busy.
+constexpr int32_t SliceNodes{1 << 16};
+
+using StatsMap = std::unordered_map<quint64, ChunkStats>;
+
+quint64 kindKey(const ChunkNode &node)
+{
+    // damaged chunks have whatever id the bytes skipped begin with
+    if (node.flags & ChunkNode::Damaged) {
+        return ~quint64(0);
+    }
+    const uint32_t listType = node.list != ChunkTable::NoNode ? node.listType : 0;
+    return quint64(node.fourcc) << 32 | listType;
+}
+
+void add(ChunkStats &stats, const ChunkStats &other)
+{
+    stats.count += other.count;
+    stats.bytes += other.bytes;
+    stats.minSize = std::min(stats.minSize, other.minSize);
+    stats.maxSize = std::max(stats.maxSize, other.maxSize);
+    stats.minDepth = std::min(stats.minDepth, other.minDepth);
+    stats.maxDepth = std::max(stats.maxDepth, other.maxDepth);
+    stats.children += other.children;
+}
+
+void countSlice(const ChunkTable &table, int32_t first, int32_t last, StatsMap &kinds)
+{
+    ProfileScope scope("count chunks");
+    scope.setArg(0, "chunks", last - first);
+    for (int32_t n = first; n < last; ++n) {
+        const ChunkNode &node = table.node(n);
+        const bool isList = node.list != ChunkTable::NoNode;
+        const bool isDamaged = node.flags & ChunkNode::Damaged;
+        // damaged bytes have no header
+        const quint64 size = node.size + (isDamaged ? 0 : RiffScanner::HeaderSize);
+        int depth = 0;
+        for (int32_t p = node.parent; p != ChunkTable::Root; p = table.node(p).parent) {
+            ++depth;
+        }
+        const ChunkStats one{node.fourcc,
+                             isList ? node.listType : 0,
+                             isList,
+                             isDamaged,
+                             1,
+                             size,
+                             size,
+                             size,
+                             depth,
+                             depth,
+                             isList ? table.childCount(n) : 0};
+        auto inserted = kinds.emplace(kindKey(node), one);
+        if (!inserted.second) {
+            add(inserted.first->second, one);
+        }
+    }
+}
+
+class CountTask : public QRunnable
+{
+public:
+    CountTask(const ChunkTable &table, int32_t first, int32_t last, StatsMap &kinds, QSemaphore &done)
+        : m_table(table)
+        , m_first(first)
+        , m_last(last)
+        , m_kinds(kinds)
+        , m_done(done)
+    {}
+
+    void run() override
+    {
+        countSlice(m_table, m_first, m_last, m_kinds);
+        m_done.release();
+    }
+
+private:
+    const ChunkTable &m_table;
+    int32_t m_first;
+    int32_t m_last;
+    StatsMap &m_kinds;
+    QSemaphore &m_done;
+};
+} // namespace
+
+std::vector<ChunkStats> ChunkStats::collect(const ChunkTable &table, QThreadPool *pool)
+{
+    ProfileScope scope("chunk statistics");
+    const int32_t end = int32_t(table.count()) + 1;
+    std::vector<StatsMap> slices(size_t((end - 1 + SliceNodes - 1) / SliceNodes));
+    if (pool == nullptr || slices.size() < 2) {
+        for (size_t i = 0; i < slices.size(); ++i) {
+            const int32_t first = 1 + int32_t(i) * SliceNodes;
+            countSlice(table, first, std::min(first + SliceNodes, end), slices[i]);
+        }
+    } else {
+        QSemaphore done;
+        for (size_t i = 0; i < slices.size(); ++i) {
+            const int32_t first = 1 + int32_t(i) * SliceNodes;
+            pool->start(new CountTask(table, first, std::min(first + SliceNodes, end), slices[i], done));
+        }
+        done.acquire(int(slices.size()));
+    }
+
+    StatsMap kinds;
+    for (const StatsMap &slice : slices) {
+        for (const auto &kind : slice) {
+            auto inserted = kinds.insert(kind);
+            if (!inserted.second) {
+                add(inserted.first->second, kind.second);
+            }
+        }
+    }
+    std::vector<ChunkStats> stats;
+    stats.reserve(kinds.size());
+    for (const auto &kind : kinds) {
+        stats.push_back(kind.second);
+    }
+    std::sort(stats.begin(), stats.end(), [](const ChunkStats &a, const ChunkStats &b) {
+        return a.bytes > b.bytes || (a.bytes == b.bytes && a.fourcc < b.fourcc);
+    });
+    scope.setArg(0, "chunks", table.count());
+    scope.setArg(1, "kinds", qint64(stats.size()));
+    return stats;
+}
@@ -0,0 +1,40 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CHUNKSTATS_H
+#define CHUNKSTATS_H
+
+#include <QtGlobal>
+#include <cstdint>
+#include <vector>
+
+#include "chunktable.h"
+
+class QThreadPool;
+
+//
+// Totals of every kind of chunk in a table: plain chunks are told apart by
+// their id, lists by their id and list type, and the damaged bytes skipped
+// by the scanner are summed up on their own. The sizes count the headers.
+//
+
+struct ChunkStats
+{
+    uint32_t fourcc;
+    uint32_t listType; // only meaningful for lists
+    bool isList;
+    bool isDamaged;
+    qint64 count;
+    quint64 bytes;
+    quint64 minSize;
+    quint64 maxSize;
+    int minDepth; // the top level chunks are at depth 0
+    int maxDepth;
+    qint64 children; // of all the lists of the kind
+
+    // one pass over the nodes, split in slices counted in parallel on the
+    // pool and merged at the end; sorted by bytes, the biggest first
+    static std::vector<ChunkStats> collect(const ChunkTable &table, QThreadPool *pool = nullptr);
+};
+
+#endif // CHUNKSTATS_H
@@ -0,0 +1,198 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    chunktable.cpp
+
+    Arena of chunk tree nodes linked by index, with per list child tables.
+*/
+
+#include <algorithm>
+
+#include "chunktable.h"
+
+constexpr int32_t ChunkTable::Root;
+constexpr int32_t ChunkTable::NoNode;
+
+ChunkTable::ChunkTable()
+{
+    clear();
+}
+
+void ChunkTable::clear()
+{
+    m_nodes.clear();
+    m_lists.clear();
+    m_nodes.push_back(ChunkNode{0, 0, 0, 0, 0, NoNode, 0, 0});
+    m_lists.push_back(ListNode{{}, 0, 0, false});
+}
+
+void ChunkTable::reserve(size_t count)
+{
+    m_nodes.reserve(count + 1);
+}
+
+int32_t ChunkTable::append(
+    int32_t parent, uint32_t fourcc, uint32_t listType, uint64_t offset, uint64_t size, uint32_t flags)
+{
+    const int32_t n = int32_t(m_nodes.size());
+    ListNode &parentList = listNode(parent);
+    const int32_t row = int32_t(parentList.children.size());
+    m_nodes.push_back(ChunkNode{fourcc, listType, offset, size, flags, parent, NoNode, row});
+    parentList.children.push_back(n);
+    return n;
+}
+
+int32_t ChunkTable::appendList(int32_t parent,
+                               uint32_t fourcc,
+                               uint32_t listType,
+                               uint64_t offset,
+                               uint64_t size,
+                               uint64_t childrenBegin,
+                               uint64_t childrenEnd,
+                               uint32_t flags)
+{
+    const int32_t n = append(parent, fourcc, listType, offset, size, flags);
+    m_nodes[size_t(n)].list = int32_t(m_lists.size());
+    m_lists.push_back(ListNode{{}, childrenBegin, childrenEnd, false});
+    return n;
+}
+
+void ChunkTable::appendSubtree(int32_t n, const ChunkTable &subtree)
+{
+    // the subtree nodes keep their order, so parents still come before
+    // their children, and the rows among siblings stay the same
+    const int32_t base = int32_t(m_nodes.size()) - 1;
+    m_nodes.reserve(m_nodes.size() + size_t(subtree.count()));
+    for (int32_t k = 1; k <= subtree.count(); ++k) {
+        ChunkNode node = subtree.node(k);
+        node.parent = node.parent == Root ? n : base + node.parent;
+        if (node.list != NoNode) {
+            const ListNode &list = subtree.m_lists[size_t(node.list)];
+            node.list = int32_t(m_lists.size());
+            m_lists.push_back(ListNode{{}, list.nextChild, list.childrenEnd, false});
+        }
+        m_nodes.push_back(node);
+        listNode(node.parent).children.push_back(base + k);
+    }
+    listNode(n).nextChild = subtree.listNode(Root).nextChild;
+}
+
+int32_t ChunkTable::childCount(int32_t n) const
+{
+    return isList(n) ? int32_t(listNode(n).children.size()) : 0;
+}
+
+int32_t ChunkTable::child(int32_t n, int32_t row) const
+{
+    if (!isList(n)) {
+        return NoNode;
+    }
+    const std::vector<int32_t> &children = listNode(n).children;
+    return row >= 0 && size_t(row) < children.size() ? children[size_t(row)] : NoNode;
+}
+
+int32_t ChunkTable::findChunk(uint64_t offset) const
+{
+    int32_t n = Root;
+    while (isList(n)) {
+        const std::vector<int32_t> &children = listNode(n).children;
+        auto it = std::upper_bound(children.begin(), children.end(), offset, [this](uint64_t offset, int32_t child) {
+            return offset < node(child).offset;
+        });
+        if (it == children.begin()) {
+            break;
+        }
+        const ChunkNode &candidate = node(*--it);
+        if (offset - candidate.offset >= 2 * sizeof(uint32_t) + candidate.size) {
+            break;
+        }
+        n = *it;
+    }
+    return n;
+}
+
+uint64_t ChunkTable::resumeOffset(const ListNode &list) const
+{
+    uint64_t next = list.nextChild;
+    if (list.fetching && !list.children.empty()) {
+        const ChunkNode &last = node(list.children.back());
+        next = std::max(next, last.offset + 2 * sizeof(uint32_t) + last.size + (last.size & 1));
+    }
+    return next;
+}
+
+bool ChunkTable::restore(const ChunkNode *nodes,
+                         size_t nodeCount,
+                         const uint64_t *listRanges,
+                         size_t listCount,
+                         uint64_t fileSize)
+{
+    clear();
+    if (nodeCount == 0 || listCount == 0) {
+        return false;
+    }
+    m_nodes.assign(nodes, nodes + nodeCount);
+    m_lists.resize(listCount);
+    for (size_t i = 0; i < listCount; ++i) {
+        m_lists[i].nextChild = listRanges[2 * i];
+        m_lists[i].childrenEnd = listRanges[2 * i + 1];
+        m_lists[i].fetching = false;
+    }
+    // children were appended in row order, so they appear in that order
+    // in the node table; anything inconsistent rejects the whole table,
+    // like a list table entry of no node or of several, or a chunk or a
+    // pending range out of its parent
+    constexpr uint64_t HeaderSize{2 * sizeof(uint32_t)};
+    const auto validRange = [](const ListNode &list, uint64_t begin, uint64_t end) {
+        return begin <= list.nextChild && list.nextChild <= list.childrenEnd && list.childrenEnd <= end;
+    };
+    if (m_nodes[Root].list != 0 || !validRange(m_lists[0], 0, fileSize)) {
+        clear();
+        return false;
+    }
+    std::vector<bool> used(listCount, false);
+    used[0] = true;
+    for (size_t n = 1; n < nodeCount; ++n) {
+        const ChunkNode &node = m_nodes[n];
+        const bool validList = node.list == NoNode
+                               || (node.list > 0 && size_t(node.list) < listCount && !used[size_t(node.list)]);
+        if (node.parent < 0 || size_t(node.parent) >= n || !isList(node.parent) || !validList) {
+            clear();
+            return false;
+        }
+        // the parents were checked before, their data ends within the file
+        const ChunkNode &parent = m_nodes[size_t(node.parent)];
+        const uint64_t parentBegin = node.parent == Root ? 0 : parent.offset + HeaderSize + sizeof(uint32_t);
+        const uint64_t parentEnd = node.parent == Root ? fileSize : parent.offset + HeaderSize + parent.size;
+        if (node.offset < parentBegin || node.offset > parentEnd || node.size > parentEnd - node.offset
+            || HeaderSize > parentEnd - node.offset - node.size) {
+            clear();
+            return false;
+        }
+        const uint64_t dataEnd = node.offset + HeaderSize + node.size;
+        if (node.list != NoNode) {
+            if (!validRange(m_lists[size_t(node.list)], node.offset + HeaderSize + sizeof(uint32_t), dataEnd)) {
+                clear();
+                return false;
+            }
+            used[size_t(node.list)] = true;
+        }
+        std::vector<int32_t> &children = listNode(node.parent).children;
+        if (node.row != int32_t(children.size())) {
+            clear();
+            return false;
+        }
+        children.push_back(int32_t(n));
+    }
+    return true;
+}
+
+size_t ChunkTable::memoryUsage() const
+{
+    size_t usage = m_nodes.capacity() * sizeof(ChunkNode) + m_lists.capacity() * sizeof(ListNode);
+    for (const ListNode &list : m_lists) {
+        usage += list.children.capacity() * sizeof(int32_t);
+    }
+    return usage;
+}
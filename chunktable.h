@@ -0,0 +1,125 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CHUNKTABLE_H
+#define CHUNKTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//
+// Flat, contiguous storage of the chunk tree. Nodes refer to each other
+// by index instead of pointers, and hold plain integers only: display
+// strings are produced by the model when a row is shown. Every node knows
+// its row, and every list keeps the indexes of its children, so that both
+// directions of the parent/child lookup take constant time.
+//
+// Node 0 is a sentinel root whose children are the top level chunks.
+//
+
+struct ChunkNode
+{
+    // what the scanner had to work around to read the chunk
+    enum Flags : uint32_t {
+        Placeholder = 1, // the size was a placeholder, it extends to the end of the parent
+        Overrun = 2,     // the size goes beyond the parent or the file, it was cut there
+        Damaged = 4,     // not a chunk: the bytes skipped to find the next plausible header
+        Resynced = 8,    // the first chunk found after damaged bytes
+    };
+
+    uint32_t fourcc;
+    uint32_t listType; // only meaningful for lists
+    uint64_t offset;
+    uint64_t size; // 64-bit for RF64 files
+    uint32_t flags;
+    int32_t parent;
+    int32_t list; // index into the list table, or NoNode for plain chunks
+    int32_t row;  // position among the children of the parent
+};
+
+//
+// Additional state kept only for RIFF and LIST chunks, which are
+// a small fraction of all nodes
+//
+
+struct ListNode
+{
+    std::vector<int32_t> children;
+    uint64_t nextChild;   // offset of the first child not scanned yet
+    uint64_t childrenEnd; // end of the data section
+    bool fetching;
+};
+
+class ChunkTable
+{
+public:
+    static constexpr int32_t Root{0};
+    static constexpr int32_t NoNode{-1};
+
+    ChunkTable();
+
+    void clear();
+    void reserve(size_t count);
+
+    int32_t append(int32_t parent,
+                   uint32_t fourcc,
+                   uint32_t listType,
+                   uint64_t offset,
+                   uint64_t size,
+                   uint32_t flags = 0);
+    int32_t appendList(int32_t parent,
+                       uint32_t fourcc,
+                       uint32_t listType,
+                       uint64_t offset,
+                       uint64_t size,
+                       uint64_t childrenBegin,
+                       uint64_t childrenEnd,
+                       uint32_t flags = 0);
+    // moves in the nodes of a table scanned on its own, whose root stands
+    // for the list n, which must have no children yet
+    void appendSubtree(int32_t n, const ChunkTable &subtree);
+
+    const ChunkNode &node(int32_t n) const { return m_nodes[size_t(n)]; }
+    int32_t count() const { return int32_t(m_nodes.size()) - 1; }
+
+    bool isList(int32_t n) const { return n == Root || m_nodes[size_t(n)].list != NoNode; }
+    ListNode &listNode(int32_t n) { return m_lists[size_t(m_nodes[size_t(n)].list)]; }
+    const ListNode &listNode(int32_t n) const { return m_lists[size_t(m_nodes[size_t(n)].list)]; }
+
+    int32_t childCount(int32_t n) const;
+    int32_t child(int32_t n, int32_t row) const;
+    int32_t row(int32_t n) const { return m_nodes[size_t(n)].row; }
+    void setSize(int32_t n, uint64_t size, uint32_t flags)
+    {
+        m_nodes[size_t(n)].size = size;
+        m_nodes[size_t(n)].flags = flags;
+    }
+
+    // the innermost chunk whose header or data holds the offset, among
+    // those scanned so far, or Root; children are sorted by offset, so
+    // this is a binary search per level
+    int32_t findChunk(uint64_t offset) const;
+
+    // where the scan of a list continues, including the children received
+    // from a fetch that did not finish
+    uint64_t resumeOffset(const ListNode &list) const;
+
+    size_t memoryUsage() const;
+
+    // raw access used to save and restore the table; lists are stored as
+    // their pending byte ranges only, the child tables are rebuilt, and
+    // nothing may lie beyond the end of the file of fileSize bytes
+    const ChunkNode *nodeData() const { return m_nodes.data(); }
+    size_t nodeCount() const { return m_nodes.size(); }
+    size_t listCount() const { return m_lists.size(); }
+    const ListNode &listAt(size_t i) const { return m_lists[i]; }
+    bool restore(const ChunkNode *nodes, size_t nodeCount, const uint64_t *listRanges, size_t listCount,
+                 uint64_t fileSize);
+
+private:
+    std::vector<ChunkNode> m_nodes;
+    std::vector<ListNode> m_lists;
+};
+
+#endif // CHUNKTABLE_H
@@ -0,0 +1,89 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+#include "diagnosticsdialog.h"
+#include "profiler.h"
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget *parent) : QDialog(parent) {
+    setWindowTitle(tr("Diagnostics"));
+    resize(520, 480);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    m_recordBox = new QCheckBox(tr("Record the time taken by opening, scanning and showing files"), this);
+    m_recordBox->setChecked(Profiler::isEnabled());
+    connect(m_recordBox, &QCheckBox::toggled, this, [](bool checked) { Profiler::setEnabled(checked); });
+    mainLayout->addWidget(m_recordBox);
+
+    m_phases = new QTreeWidget(this);
+    m_phases->setRootIsDecorated(false);
+    m_phases->setHeaderLabels({tr("Phase"), tr("Calls"), tr("Total (ms)"), tr("Longest (ms)")});
+    mainLayout->addWidget(new QLabel(tr("Phases"), this));
+    mainLayout->addWidget(m_phases, 2);
+
+    m_counters = new QTreeWidget(this);
+    m_counters->setRootIsDecorated(false);
+    m_counters->setHeaderLabels({tr("Counter"), tr("Value")});
+    mainLayout->addWidget(new QLabel(tr("Counters"), this));
+    mainLayout->addWidget(m_counters, 1);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    QPushButton *refreshButton = buttonBox->addButton(tr("&Refresh"), QDialogButtonBox::ActionRole);
+    QPushButton *clearButton = buttonBox->addButton(tr("C&lear"), QDialogButtonBox::ActionRole);
+    QPushButton *exportButton = buttonBox->addButton(tr("&Export Trace..."), QDialogButtonBox::ActionRole);
+    connect(refreshButton, &QPushButton::clicked, this, &DiagnosticsDialog::refresh);
+    connect(clearButton, &QPushButton::clicked, this, &DiagnosticsDialog::clear);
+    connect(exportButton, &QPushButton::clicked, this, &DiagnosticsDialog::exportTrace);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttonBox);
+
+    refresh();
+}
+
+void DiagnosticsDialog::refresh()
+{
+    m_phases->clear();
+    for (const PhaseSummary &phase : Profiler::phases()) {
+        auto *item = new QTreeWidgetItem(m_phases);
+        item->setText(0, phase.name);
+        item->setText(1, QString::number(phase.count));
+        item->setText(2, QString::number(phase.total / 1e6, 'f', 3));
+        item->setText(3, QString::number(phase.longest / 1e6, 'f', 3));
+        for (int column = 1; column < 4; ++column) {
+            item->setTextAlignment(column, Qt::AlignRight);
+        }
+    }
+    m_phases->resizeColumnToContents(0);
+
+    m_counters->clear();
+    for (const auto &counter : Profiler::counters()) {
+        auto *item = new QTreeWidgetItem(m_counters);
+        item->setText(0, counter.first);
+        item->setText(1, QString::number(counter.second));
+        item->setTextAlignment(1, Qt::AlignRight);
+    }
+    m_counters->resizeColumnToContents(0);
+}
+
+void DiagnosticsDialog::clear()
+{
+    Profiler::clear();
+    refresh();
+}
+
+void DiagnosticsDialog::exportTrace()
+{
+    const QString fileName = QFileDialog::getSaveFileName(this,
+                                                          tr("Export Trace"),
+                                                          QStringLiteral("rifftree-trace.json"),
+                                                          tr("Trace Event Files (*.json)"));
+    if (!fileName.isEmpty() && !Profiler::exportTrace(fileName)) {
+        QMessageBox::warning(this, windowTitle(), tr("Cannot write %1").arg(fileName));
+    }
+}
@@ -0,0 +1,29 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QCheckBox>
+#include <QDialog>
+#include <QTreeWidget>
+
+class DiagnosticsDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit DiagnosticsDialog(QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+
+private slots:
+    void clear();
+    void exportTrace();
+
+private:
+    QCheckBox *m_recordBox;
+    QTreeWidget *m_phases;
+    QTreeWidget *m_counters;
+};
+
+#endif // DIAGNOSTICSDIALOG_H
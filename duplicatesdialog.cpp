@@ -0,0 +1,269 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QDialogButtonBox>
+#include <QLocale>
+#include <QRunnable>
+#include <QVBoxLayout>
+#include <algorithm>
+
+#include "chunkhash.h"
+#include "chunkquery.h"
+#include "duplicatesdialog.h"
+#include "profiler.h"
+#include "riffscanner.h"
+
+namespace {
+// the offset of the chunk rows, the offset of the first copy in group rows
+class DuplicateItem : public QTreeWidgetItem
+{
+public:
+    DuplicateItem(qint64 offset, qint64 length)
+        : m_offset(offset)
+        , m_length(length)
+    {}
+
+    qint64 offset() const { return m_offset; }
+    qint64 length() const { return m_length; }
+
+private:
+    qint64 m_offset;
+    qint64 m_length;
+};
+} // namespace
+
+constexpr int DuplicatesDialog::MaxGroups;
+
+//
+// Only the leaf chunks are compared: a list holding the same data as
+// another one would repeat the groups of its children. Chunks of a size
+// no other chunk has cannot be duplicates and are never read.
+//
+
+class DuplicatesDialog::Job : public QRunnable
+{
+public:
+    Job(DuplicatesDialog *dialog, int generation, const uint8_t *buffer, qint64 length, bool carved)
+        : m_dialog(dialog)
+        , m_generation(generation)
+        , m_buffer(buffer)
+        , m_length(length)
+        , m_carved(carved)
+    {}
+
+    void run() override
+    {
+        ProfileScope scope("find duplicates");
+        ChunkTable table;
+        if (m_carved) {
+            RiffScanner::carveTree(m_buffer, m_length, table, QThreadPool::globalInstance(), m_dialog->m_cancelled);
+        } else {
+            RiffScanner::scanTree(m_buffer, m_length, table, QThreadPool::globalInstance(), m_dialog->m_cancelled);
+        }
+        if (m_dialog->m_cancelled) {
+            return;
+        }
+        auto payload = [&](int32_t n) { return ChunkHash::payloadLength(table.node(n), m_length); };
+        std::vector<int32_t> leaves;
+        for (int32_t n = 1; n <= table.count(); ++n) {
+            if (table.node(n).list == ChunkTable::NoNode && payload(n) > 0) {
+                leaves.push_back(n);
+            }
+        }
+        std::stable_sort(leaves.begin(), leaves.end(), [&](int32_t a, int32_t b) { return payload(a) < payload(b); });
+        std::vector<int32_t> candidates;
+        for (size_t i = 0; i < leaves.size(); ++i) {
+            const qint64 size = payload(leaves[i]);
+            if ((i > 0 && payload(leaves[i - 1]) == size)
+                || (i + 1 < leaves.size() && payload(leaves[i + 1]) == size)) {
+                candidates.push_back(leaves[i]);
+            }
+        }
+        scope.setArg(0, "chunks", qint64(leaves.size()));
+        scope.setArg(1, "hashed", qint64(candidates.size()));
+        const std::vector<quint64> hashes = ChunkHash::hashNodes(m_buffer,
+                                                                 m_length,
+                                                                 table,
+                                                                 candidates,
+                                                                 QThreadPool::globalInstance(),
+                                                                 m_dialog->m_cancelled);
+        if (m_dialog->m_cancelled) {
+            return;
+        }
+
+        // the candidates are in size order already, the hashes sort each size
+        std::vector<size_t> order(candidates.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            const qint64 sizeA = payload(candidates[a]);
+            const qint64 sizeB = payload(candidates[b]);
+            return sizeA < sizeB || (sizeA == sizeB && hashes[a] < hashes[b]);
+        });
+        std::vector<Group> groups;
+        for (size_t first = 0; first < order.size();) {
+            size_t last = first + 1;
+            const qint64 size = payload(candidates[order[first]]);
+            while (last < order.size() && payload(candidates[order[last]]) == size
+                   && hashes[order[last]] == hashes[order[first]]) {
+                ++last;
+            }
+            if (last - first > 1) {
+                Group group{quint64(size), hashes[order[first]], {}, {}};
+                for (size_t i = first; i < last; ++i) {
+                    group.offsets.append(qint64(table.node(candidates[order[i]]).offset));
+                }
+                groups.push_back(group);
+            }
+            first = last;
+        }
+        std::stable_sort(groups.begin(), groups.end(), [](const Group &a, const Group &b) {
+            return a.size * quint64(a.offsets.size() - 1) > b.size * quint64(b.offsets.size() - 1);
+        });
+        if (groups.size() > size_t(MaxGroups)) {
+            groups.resize(size_t(MaxGroups));
+        }
+        ChunkLabels labels;
+        for (Group &group : groups) {
+            for (const qint64 offset : group.offsets) {
+                group.paths.append(ChunkQuery::path(table, table.findChunk(quint64(offset)), labels));
+            }
+        }
+
+        DuplicatesDialog *dialog = m_dialog;
+        const int generation = m_generation;
+        const int chunks = int(leaves.size());
+        const int hashed = int(candidates.size());
+        QMetaObject::invokeMethod(
+            dialog,
+            [=] { dialog->jobDone(generation, groups, chunks, hashed); },
+            Qt::QueuedConnection);
+    }
+
+private:
+    DuplicatesDialog *m_dialog;
+    int m_generation;
+    const uint8_t *m_buffer;
+    qint64 m_length;
+    bool m_carved;
+};
+
+DuplicatesDialog::DuplicatesDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Duplicate Chunks"));
+    resize(620, 480);
+    // the job waits for the hashing on the global pool
+    m_pool.setMaxThreadCount(1);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    m_results = new QTreeWidget(this);
+    m_results->setHeaderLabels({tr("Chunk"), tr("Offset"), tr("Size"), tr("Hash")});
+    mainLayout->addWidget(m_results, 1);
+    m_status = new QLabel(this);
+    mainLayout->addWidget(m_status);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    m_findButton = buttonBox->addButton(tr("&Find"), QDialogButtonBox::ActionRole);
+    m_stopButton = buttonBox->addButton(tr("S&top"), QDialogButtonBox::ActionRole);
+    m_findButton->setDefault(true);
+    m_stopButton->setEnabled(false);
+    connect(m_findButton, &QPushButton::clicked, this, &DuplicatesDialog::find);
+    connect(m_stopButton, &QPushButton::clicked, this, &DuplicatesDialog::stop);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttonBox);
+
+    connect(m_results, &QTreeWidget::itemActivated, this, &DuplicatesDialog::activateItem);
+    connect(m_results, &QTreeWidget::itemClicked, this, &DuplicatesDialog::activateItem);
+}
+
+DuplicatesDialog::~DuplicatesDialog()
+{
+    stop();
+}
+
+void DuplicatesDialog::setFile(const uint8_t *buffer, qint64 length, bool carved)
+{
+    stop();
+    if (buffer != m_buffer || length != m_length) {
+        m_results->clear();
+        m_status->clear();
+    }
+    m_buffer = buffer;
+    m_length = length;
+    m_carved = carved;
+    m_findButton->setEnabled(buffer != nullptr);
+}
+
+void DuplicatesDialog::find()
+{
+    stop();
+    if (m_buffer == nullptr) {
+        return;
+    }
+    m_results->clear();
+    m_status->setText(tr("Hashing..."));
+    m_findButton->setEnabled(false);
+    m_stopButton->setEnabled(true);
+    m_pool.start(new Job(this, m_generation, m_buffer, m_length, m_carved));
+}
+
+void DuplicatesDialog::stop()
+{
+    // the result of a job still queued for the GUI thread is ignored
+    ++m_generation;
+    m_cancelled = true;
+    m_pool.clear();
+    m_pool.waitForDone();
+    m_cancelled = false;
+    if (m_stopButton->isEnabled()) {
+        m_status->setText(tr("Stopped"));
+    }
+    m_findButton->setEnabled(m_buffer != nullptr);
+    m_stopButton->setEnabled(false);
+}
+
+void DuplicatesDialog::jobDone(int generation, const std::vector<Group> &groups, int chunks, int hashed)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    const QLocale locale;
+    QList<QTreeWidgetItem *> items;
+    quint64 wasted = 0;
+    for (const Group &group : groups) {
+        const qint64 length = RiffScanner::HeaderSize + qint64(group.size);
+        auto *item = new DuplicateItem(group.offsets.first(), length);
+        item->setText(0, tr("%1 copies").arg(group.offsets.size()));
+        item->setText(2, QString::number(group.size));
+        item->setTextAlignment(2, Qt::AlignRight);
+        item->setText(3, QString("%1").arg(group.hash, 16, 16, QLatin1Char('0')));
+        for (int i = 0; i < group.offsets.size(); ++i) {
+            auto *child = new DuplicateItem(group.offsets.at(i), length);
+            child->setText(0, group.paths.at(i));
+            child->setText(1, QString::number(group.offsets.at(i)));
+            child->setTextAlignment(1, Qt::AlignRight);
+            item->addChild(child);
+        }
+        items.append(item);
+        wasted += group.size * quint64(group.offsets.size() - 1);
+    }
+    m_results->addTopLevelItems(items);
+    m_results->resizeColumnToContents(0);
+    m_status->setText(tr("%1 groups of duplicates, %2 in the copies; %3 of %4 chunks hashed")
+                          .arg(groups.size())
+                          .arg(locale.formattedDataSize(qint64(wasted)))
+                          .arg(hashed)
+                          .arg(chunks));
+    m_findButton->setEnabled(true);
+    m_stopButton->setEnabled(false);
+}
+
+void DuplicatesDialog::activateItem(QTreeWidgetItem *item)
+{
+    if (item != nullptr) {
+        const auto *duplicate = static_cast<DuplicateItem *>(item);
+        emit chunkActivated(duplicate->offset(), duplicate->length());
+    }
+}
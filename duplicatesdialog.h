@@ -0,0 +1,67 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DUPLICATESDIALOG_H
+#define DUPLICATESDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QPushButton>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTreeWidget>
+#include <QVector>
+#include <atomic>
+#include <vector>
+
+//
+// Lists the chunks of the open file holding the same data: the whole file
+// is scanned, the payloads of the chunks whose size is shared by another
+// one are hashed in parallel, and the chunks are grouped by size and hash.
+//
+
+class DuplicatesDialog : public QDialog {
+    Q_OBJECT
+public:
+    // the groups shown, the biggest savings first
+    static constexpr int MaxGroups{10000};
+
+    struct Group
+    {
+        quint64 size;
+        quint64 hash;
+        QVector<qint64> offsets;
+        QStringList paths;
+    };
+
+    explicit DuplicatesDialog(QWidget *parent = nullptr);
+    ~DuplicatesDialog() override;
+
+    // the file searched, carved or not like its tree; a search running is stopped
+    void setFile(const uint8_t *buffer, qint64 length, bool carved);
+
+signals:
+    void chunkActivated(qint64 offset, qint64 length);
+
+private slots:
+    void find();
+    void stop();
+    void activateItem(QTreeWidgetItem *item);
+
+private:
+    class Job;
+    void jobDone(int generation, const std::vector<Group> &groups, int chunks, int hashed);
+
+    const uint8_t *m_buffer{nullptr};
+    qint64 m_length{0};
+    bool m_carved{false};
+    QThreadPool m_pool;
+    std::atomic<bool> m_cancelled{false};
+    int m_generation{0};
+    QTreeWidget *m_results;
+    QLabel *m_status;
+    QPushButton *m_findButton;
+    QPushButton *m_stopButton;
+};
+
+#endif // DUPLICATESDIALOG_H
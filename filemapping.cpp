@@ -0,0 +1,135 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "filemapping.h"
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+constexpr qint64 FileMapping::SmallFileLimit;
+constexpr qint64 FileMapping::PrefetchLimit;
+
+namespace {
+const char *const PolicyNames[]{"default", "advise", "populate"};
+
+#if defined(Q_OS_LINUX)
+uintptr_t pageSize()
+{
+    static const uintptr_t size = uintptr_t(sysconf(_SC_PAGESIZE));
+    return size;
+}
+#endif
+} // namespace
+
+bool FileMapping::isNative()
+{
+#if defined(Q_OS_LINUX)
+    return true;
+#else
+    return false;
+#endif
+}
+
+QStringList FileMapping::policyNames()
+{
+    QStringList names;
+    for (const char *name : PolicyNames) {
+        names.append(QString::fromLatin1(name));
+    }
+    return names;
+}
+
+QString FileMapping::policyName(Policy policy)
+{
+    return QString::fromLatin1(PolicyNames[policy]);
+}
+
+FileMapping::Policy FileMapping::policy(const QString &name, bool *ok)
+{
+    const int index = policyNames().indexOf(name.toLower());
+    if (ok != nullptr) {
+        *ok = index >= 0;
+    }
+    return index >= 0 ? Policy(index) : Default;
+}
+
+uint8_t *FileMapping::map(QFile &file, qint64 size, Policy policy)
+{
+    if (size <= 0) {
+        return nullptr;
+    }
+#if defined(Q_OS_LINUX)
+    if (quint64(size) > quint64(size_t(-1)) || file.handle() < 0) {
+        return nullptr;
+    }
+    if (size > SmallFileLimit && policy == Populate) {
+        policy = Advise;
+    }
+    const int flags = policy == Populate ? MAP_SHARED | MAP_POPULATE : MAP_SHARED;
+    void *data = mmap(nullptr, size_t(size), PROT_READ, flags, file.handle(), 0);
+    return data == MAP_FAILED ? nullptr : static_cast<uint8_t *>(data);
+#else
+    Q_UNUSED(policy)
+    return file.map(0, size);
+#endif
+}
+
+bool FileMapping::unmap(QFile &file, uint8_t *buffer, qint64 size)
+{
+#if defined(Q_OS_LINUX)
+    Q_UNUSED(file)
+    return munmap(buffer, size_t(size)) == 0;
+#else
+    Q_UNUSED(size)
+    return file.unmap(buffer);
+#endif
+}
+
+void FileMapping::advise(uint8_t *buffer, qint64 size, Policy policy, Access access)
+{
+#if defined(Q_OS_LINUX)
+    if (buffer != nullptr && size > 0 && policy != Default) {
+        madvise(buffer, size_t(size), access == Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    }
+#else
+    Q_UNUSED(buffer)
+    Q_UNUSED(size)
+    Q_UNUSED(policy)
+    Q_UNUSED(access)
+#endif
+}
+
+void FileMapping::prefetch(uint8_t *buffer, qint64 size, Policy policy, qint64 offset, qint64 length)
+{
+#if defined(Q_OS_LINUX)
+    const qint64 begin = qBound(qint64(0), offset, size);
+    const qint64 end = qBound(begin, offset + qMin(length, PrefetchLimit), size);
+    if (buffer == nullptr || policy == Default || end <= begin) {
+        return;
+    }
+    // madvise() takes page aligned addresses
+    const uintptr_t first = uintptr_t(buffer + begin) & ~(pageSize() - 1);
+    madvise(reinterpret_cast<void *>(first), uintptr_t(buffer + end) - first, MADV_WILLNEED);
+#else
+    Q_UNUSED(buffer)
+    Q_UNUSED(size)
+    Q_UNUSED(policy)
+    Q_UNUSED(offset)
+    Q_UNUSED(length)
+#endif
+}
+
+bool FileMapping::evict(QFile &file)
+{
+#if defined(Q_OS_LINUX)
+    // dirty pages are not dropped, they are written first
+    return file.handle() >= 0 && fdatasync(file.handle()) == 0
+           && posix_fadvise(file.handle(), 0, 0, POSIX_FADV_DONTNEED) == 0;
+#else
+    Q_UNUSED(file)
+    return false;
+#endif
+}
@@ -0,0 +1,61 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILEMAPPING_H
+#define FILEMAPPING_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <cstdint>
+
+//
+// The mapping of a whole file with a policy for reading it from disk.
+// On Linux the file is mapped with mmap() and the policy tells the kernel
+// how it is going to be read: sequentially while the tree is scanned, at
+// random while it is browsed, and the bytes of the chunk selected before
+// they are shown. Small and medium files can also be read whole when they
+// are mapped. QFile::map is used on the other systems, where the hints
+// have no effect.
+//
+// There is no huge pages policy: MADV_HUGEPAGE does nothing for mappings
+// of the page cache in most kernels, which need READ_ONLY_THP_FOR_FS and
+// khugepaged for it, and measured the same as Advise.
+//
+
+class FileMapping
+{
+public:
+    enum Policy {
+        Default,   // no hints, the readahead of the kernel
+        Advise,    // access pattern hints and prefetching of the selection
+        Populate,  // the same, reading the whole file when it is mapped
+    };
+    enum Access { Sequential, Random };
+
+    // larger files are mapped with Advise instead of Populate
+    static constexpr qint64 SmallFileLimit{256 << 20};
+    // at most the first bytes of a chunk selected are prefetched
+    static constexpr qint64 PrefetchLimit{4 << 20};
+
+    static bool isNative();
+    static QStringList policyNames();
+    static QString policyName(Policy policy);
+    // Default when the name is not known
+    static Policy policy(const QString &name, bool *ok = nullptr);
+
+    // the first size bytes of the open file, nullptr when they could not be mapped
+    static uint8_t *map(QFile &file, qint64 size, Policy policy);
+    static bool unmap(QFile &file, uint8_t *buffer, qint64 size);
+
+    // how the mapping is going to be read from now on
+    static void advise(uint8_t *buffer, qint64 size, Policy policy, Access access);
+    // starts reading the range in the background, before it is shown
+    static void prefetch(uint8_t *buffer, qint64 size, Policy policy, qint64 offset, qint64 length);
+    // writes the pages of the file and drops them from the page cache, for
+    // cold reads; false when the system does not allow it
+    static bool evict(QFile &file);
+};
+
+#endif // FILEMAPPING_H
@@ -0,0 +1,175 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QMutexLocker>
+#include <vector>
+
+#include "filewindows.h"
+#include "profiler.h"
+
+namespace {
+// what a reader sees of the bytes that could not be mapped
+const uint8_t Zeros[FileWindows::Reader::MaxRead]{};
+} // namespace
+
+constexpr qint64 FileWindows::WindowSize;
+constexpr qint64 FileWindows::WindowOverlap;
+constexpr qint64 FileWindows::Reader::MaxRead;
+
+struct FileWindows::Mapping
+{
+    Mapping(FileWindows *owner, uchar *data, qint64 offset, qint64 length)
+        : owner(owner)
+        , data(data)
+        , offset(offset)
+        , length(length)
+    {}
+    ~Mapping() { owner->unmap(data); }
+
+    FileWindows *owner;
+    uchar *data;
+    qint64 offset;
+    qint64 length;
+};
+
+FileWindows::Window::Window(std::shared_ptr<const Mapping> mapping)
+    : m_mapping(std::move(mapping))
+{}
+
+const uint8_t *FileWindows::Window::data() const
+{
+    return m_mapping->data;
+}
+
+qint64 FileWindows::Window::offset() const
+{
+    return m_mapping->offset;
+}
+
+qint64 FileWindows::Window::length() const
+{
+    return m_mapping->length;
+}
+
+bool FileWindows::Window::contains(qint64 pos, qint64 size) const
+{
+    return isValid() && pos >= m_mapping->offset && pos + size <= m_mapping->offset + m_mapping->length;
+}
+
+FileWindows::Reader::Reader(FileWindows *windows)
+    : m_windows(windows)
+{}
+
+const uint8_t *FileWindows::Reader::remap(qint64 pos, qint64 size)
+{
+    Q_ASSERT(size <= MaxRead);
+    m_window = m_windows->map(pos, size);
+    if (!m_window.isValid()) {
+        m_failed = true;
+        m_data = nullptr;
+        m_begin = m_end = 0;
+        return Zeros;
+    }
+    m_data = m_window.data();
+    m_begin = m_window.offset();
+    m_end = m_begin + m_window.length();
+    return m_data + (pos - m_begin);
+}
+
+FileWindows::FileWindows(const QString &fileName, qint64 budget)
+    : m_file(fileName)
+    , m_budget(budget)
+{}
+
+FileWindows::~FileWindows()
+{
+    // the windows still held elsewhere must be gone by now
+    m_recent.clear();
+}
+
+bool FileWindows::open()
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    m_size = m_file.size();
+    return true;
+}
+
+QString FileWindows::fileName() const
+{
+    return m_file.fileName();
+}
+
+QString FileWindows::errorString() const
+{
+    return m_file.errorString();
+}
+
+qint64 FileWindows::size() const
+{
+    return m_size;
+}
+
+qint64 FileWindows::budget() const
+{
+    return m_budget;
+}
+
+FileWindows::Window FileWindows::map(qint64 offset, qint64 length)
+{
+    // the windows dropped from the cache are unmapped after the lock is
+    // released, the destructor of the mappings takes it again
+    std::vector<std::shared_ptr<const Mapping>> dropped;
+    QMutexLocker locker(&m_mutex);
+    if (offset < 0 || length <= 0 || offset + length > m_size) {
+        return {};
+    }
+    const qint64 begin = offset - offset % WindowSize;
+    // longer ranges, which readers never ask for, get a mapping of their own
+    const bool cached = offset + length <= begin + WindowSize + WindowOverlap;
+    if (cached) {
+        for (auto it = m_recent.begin(); it != m_recent.end(); ++it) {
+            if ((*it)->offset == begin) {
+                m_recent.splice(m_recent.begin(), m_recent, it);
+                return Window(m_recent.front());
+            }
+        }
+    }
+    const qint64 mapOffset = cached ? begin : offset;
+    const qint64 mapLength = cached ? qMin(WindowSize + WindowOverlap, m_size - begin) : length;
+    ProfileScope scope("map window");
+    scope.setArg(0, "offset", mapOffset);
+    scope.setArg(1, "bytes", mapLength);
+    uchar *data = m_file.map(mapOffset, mapLength);
+    if (data == nullptr) {
+        return {};
+    }
+    auto mapping = std::make_shared<const Mapping>(this, data, mapOffset, mapLength);
+    if (cached) {
+        m_recent.push_front(mapping);
+        // at least the window just mapped, whatever the budget
+        const size_t maxWindows = size_t(qMax(m_budget / (WindowSize + WindowOverlap), qint64(1)));
+        while (m_recent.size() > maxWindows) {
+            dropped.push_back(std::move(m_recent.back()));
+            m_recent.pop_back();
+        }
+    }
+    return Window(mapping);
+}
+
+qint64 FileWindows::mappedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 bytes = 0;
+    for (const auto &mapping : m_recent) {
+        bytes += mapping->length;
+    }
+    return bytes;
+}
+
+void FileWindows::unmap(uchar *data)
+{
+    QMutexLocker locker(&m_mutex);
+    m_file.unmap(data);
+}
@@ -0,0 +1,111 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILEWINDOWS_H
+#define FILEWINDOWS_H
+
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QtGlobal>
+#include <cstdint>
+#include <list>
+#include <memory>
+
+//
+// A file too large to be mapped at once, in the address space of 32-bit
+// builds or within the memory budget, mapped a window at a time instead.
+// Windows are aligned to WindowSize and overlap the next one by a little,
+// so that the headers read across their ends need no other mapping. The
+// windows used most recently stay mapped while they fit in the budget,
+// the others are unmapped. A Window keeps its mapping alive while it is
+// held, even when it has been dropped from the cache meanwhile, so the
+// readers of every thread can share one instance.
+//
+
+class FileWindows
+{
+    struct Mapping;
+
+public:
+    static constexpr qint64 WindowSize{16 << 20};
+    static constexpr qint64 WindowOverlap{64 << 10};
+
+    class Window
+    {
+    public:
+        Window() = default;
+
+        bool isValid() const { return m_mapping != nullptr; }
+        const uint8_t *data() const;
+        qint64 offset() const;
+        qint64 length() const;
+        bool contains(qint64 pos, qint64 size) const;
+
+    private:
+        friend class FileWindows;
+        explicit Window(std::shared_ptr<const Mapping> mapping);
+
+        std::shared_ptr<const Mapping> m_mapping;
+    };
+
+    //
+    // Reads of a few bytes at a time, like the scanner does, through the
+    // window holding the last ones. Not thread safe: one per thread.
+    //
+    class Reader
+    {
+    public:
+        explicit Reader(FileWindows *windows);
+
+        // size bytes at pos, zeros when they could not be mapped; no more
+        // than MaxRead bytes are read at once
+        const uint8_t *at(qint64 pos, qint64 size)
+        {
+            if (pos < m_begin || pos + size > m_end) {
+                return remap(pos, size);
+            }
+            return m_data + (pos - m_begin);
+        }
+        bool hasFailed() const { return m_failed; }
+
+        static constexpr qint64 MaxRead{64};
+
+    private:
+        const uint8_t *remap(qint64 pos, qint64 size);
+
+        FileWindows *m_windows;
+        Window m_window;
+        const uint8_t *m_data{nullptr};
+        qint64 m_begin{0};
+        qint64 m_end{0};
+        bool m_failed{false};
+    };
+
+    FileWindows(const QString &fileName, qint64 budget);
+    ~FileWindows();
+
+    bool open();
+    QString fileName() const;
+    QString errorString() const;
+    qint64 size() const;
+    qint64 budget() const;
+
+    // the window holding the range, or an invalid one when it is outside
+    // of the file or could not be mapped
+    Window map(qint64 offset, qint64 length);
+    // the bytes of the windows kept mapped by the cache
+    qint64 mappedBytes() const;
+
+private:
+    void unmap(uchar *data);
+
+    QFile m_file;
+    qint64 m_size{0};
+    qint64 m_budget;
+    mutable QMutex m_mutex;
+    // most recently used first
+    std::list<std::shared_ptr<const Mapping>> m_recent;
+};
+
+#endif // FILEWINDOWS_H
@@ -0,0 +1,99 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    fuzz_scanner.cpp
+
+    libFuzzer target for the chunk scanner. Besides running under the
+    sanitizers, every input is checked for:
+
+    - nodes inside the input and inside their parents
+    - children in increasing offset order
+    - the same chunks when a list is scanned in small batches, resuming
+      where the previous batch stopped, as the tree model does
+    - carved containers that do not overlap
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "chunktable.h"
+#include "riffscanner.h"
+
+namespace {
+
+void check(bool condition)
+{
+    if (!condition) {
+        __builtin_trap();
+    }
+}
+
+void checkTable(const ChunkTable &table, qint64 length)
+{
+    for (int32_t n = 1; n <= table.count(); ++n) {
+        const ChunkNode &node = table.node(n);
+        const qint64 begin = qint64(node.offset);
+        const qint64 end = begin + RiffScanner::HeaderSize + qint64(node.size);
+        check(begin >= 0 && end <= length);
+        if (node.parent != ChunkTable::Root) {
+            const ChunkNode &parent = table.node(node.parent);
+            check(begin >= qint64(parent.offset) + RiffScanner::HeaderSize);
+            check(end <= qint64(parent.offset) + RiffScanner::HeaderSize + qint64(parent.size));
+        }
+        if (node.row > 0) {
+            const int32_t previous = table.child(node.parent, node.row - 1);
+            check(table.node(previous).offset < node.offset);
+        }
+    }
+}
+
+void checkBatches(const uint8_t *data, qint64 length, const ChunkTable &table, int batchSize)
+{
+    const RiffScanner::Format format = RiffScanner::format(data, length);
+    for (int32_t n = 1; n <= table.count(); ++n) {
+        if (!table.isList(n)) {
+            continue;
+        }
+        const qint64 end = qint64(table.listNode(n).childrenEnd);
+        qint64 pos = qint64(table.node(n).offset) + RiffScanner::HeaderSize + qint64(sizeof(uint32_t));
+        std::vector<ChunkRecord> records;
+        for (qint64 previous = -1; pos < end && pos != previous;) {
+            int count = 0;
+            previous = pos;
+            pos = RiffScanner::scanChildren(format, data, pos, end, [&](const ChunkRecord &record) {
+                records.push_back(record);
+                return ++count < batchSize;
+            });
+        }
+        // chunks found after damaged bytes are flagged by the batch that
+        // skipped them, so only the positions and sizes are compared
+        check(records.size() == size_t(table.childCount(n)));
+        for (size_t i = 0; i < records.size(); ++i) {
+            const ChunkNode &child = table.node(table.child(n, int32_t(i)));
+            check(quint64(records[i].offset) == child.offset && records[i].size == child.size);
+        }
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const qint64 length = qint64(size);
+    ChunkTable table;
+    RiffScanner::scanTree(data, length, table);
+    checkTable(table, length);
+    if (size > 0) {
+        checkBatches(data, length, table, 1 + data[size - 1] % 7);
+    }
+    RiffScanner::carveTree(data, length, table);
+    checkTable(table, length);
+    for (int32_t row = 1; row < table.childCount(ChunkTable::Root); ++row) {
+        const ChunkNode &previous = table.node(table.child(ChunkTable::Root, row - 1));
+        const ChunkNode &node = table.node(table.child(ChunkTable::Root, row));
+        check(previous.offset + RiffScanner::HeaderSize + previous.size <= node.offset);
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QEvent>
+#include <QScrollBar>
+#include <algorithm>
+#include <vector>
+
+#include "hexoverlay.h"
+#include "profiler.h"
+#include "riffscanner.h"
+#include "treemodel.h"
+
+namespace {
+// the hues of the nesting levels, repeated below the last one
+const int LevelHues[]{210, 120, 30, 280, 180, 330};
+} // namespace
+
+HexOverlay::HexOverlay(QHexView *view, QObject *parent)
+    : QObject(parent)
+    , m_view(view)
+    , m_timer(new QTimer(this))
+{
+    // scrolling emits a burst of changes, the overlay follows the last one
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(0);
+    connect(m_timer, &QTimer::timeout, this, &HexOverlay::updateOverlay);
+    connect(m_view->verticalScrollBar(), &QScrollBar::valueChanged, this, &HexOverlay::refresh);
+    m_view->viewport()->installEventFilter(this);
+}
+
+void HexOverlay::setModel(TreeModel *model)
+{
+    if (m_model != nullptr) {
+        disconnect(m_model, nullptr, this, nullptr);
+    }
+    m_model = model;
+    if (m_model != nullptr) {
+        // lists are scanned as they are expanded, and the whole tree may be
+        // replaced by the one of the index cache
+        connect(m_model, &QAbstractItemModel::rowsInserted, this, &HexOverlay::refresh);
+        connect(m_model, &QAbstractItemModel::modelReset, this, &HexOverlay::refresh);
+    }
+    refresh();
+}
+
+void HexOverlay::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    refresh();
+}
+
+void HexOverlay::refresh()
+{
+    m_timer->start();
+}
+
+bool HexOverlay::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_view->viewport() && event->type() == QEvent::Resize) {
+        refresh();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void HexOverlay::updateOverlay()
+{
+    ProfileScope scope("hex overlay");
+    m_view->clearMetadata();
+    m_ranges = 0;
+    QHexDocument *document = m_view->hexDocument();
+    if (!m_enabled || m_model == nullptr || document == nullptr) {
+        return;
+    }
+    // a row more than fits, for the one partially shown at the bottom
+    const quint64 lineLength = m_view->options().linelength;
+    const int lineHeight = std::max(m_view->fontMetrics().height(), 1);
+    const quint64 lines = quint64(m_view->viewport()->height() / lineHeight + 1);
+    m_begin = quint64(m_view->verticalScrollBar()->value()) * lineLength;
+    m_end = std::min(m_begin + lines * lineLength, quint64(document->length()));
+    if (m_begin < m_end) {
+        colourChildren(m_model->chunks(), ChunkTable::Root, 0);
+    }
+    scope.setArg(0, "bytes", qint64(m_end - m_begin));
+    scope.setArg(1, "ranges", m_ranges);
+}
+
+void HexOverlay::colourChildren(const ChunkTable &table, int32_t parent, int depth)
+{
+    // iterative, the lists of a crafted file may be nested very deep
+    std::vector<std::pair<int32_t, int>> lists{{parent, depth}};
+    while (!lists.empty()) {
+        const int32_t list = lists.back().first;
+        const int level = lists.back().second;
+        lists.pop_back();
+        // the children are sorted by offset: the first one shown is the last
+        // starting before the viewport, or the first one
+        const std::vector<int32_t> &children = table.listNode(list).children;
+        auto it = std::upper_bound(children.begin(), children.end(), m_begin, [&](quint64 offset, int32_t child) {
+            return offset < table.node(child).offset;
+        });
+        if (it != children.begin()) {
+            --it;
+        }
+        for (; it != children.end(); ++it) {
+            const ChunkNode &node = table.node(*it);
+            if (node.offset >= m_end) {
+                break;
+            }
+            const quint64 data = node.offset + RiffScanner::HeaderSize;
+            if (data + node.size + (node.size & 1) <= m_begin) {
+                continue;
+            }
+            if (node.flags & ChunkNode::Damaged) {
+                colour(node.offset, data + node.size, QColor(255, 170, 170));
+                continue;
+            }
+            colour(node.offset, node.offset + sizeof(uint32_t), fieldColor(IdField, level));
+            colour(node.offset + sizeof(uint32_t), data, fieldColor(SizeField, level));
+            if (table.isList(*it)) {
+                colour(data, data + sizeof(uint32_t), fieldColor(TypeField, level));
+                lists.emplace_back(*it, level + 1);
+            } else {
+                colour(data, data + node.size, fieldColor(PayloadField, level));
+                if (node.size & 1) {
+                    colour(data + node.size, data + node.size + 1, fieldColor(PadField, level));
+                }
+            }
+        }
+    }
+}
+
+// the part of the range in the viewport; a payload of gigabytes would
+// otherwise add metadata to every one of its rows
+void HexOverlay::colour(quint64 begin, quint64 end, const QColor &color)
+{
+    begin = std::max(begin, m_begin);
+    end = std::min(end, m_end);
+    if (begin < end) {
+        m_view->setBackground(qint64(begin), qint64(end), color);
+        ++m_ranges;
+    }
+}
+
+// the hue tells the level, the saturation the field
+QColor HexOverlay::fieldColor(Field field, int depth)
+{
+    const int hue = LevelHues[size_t(depth) % (sizeof(LevelHues) / sizeof(LevelHues[0]))];
+    switch (field) {
+    case IdField:
+        return QColor::fromHsv(hue, 110, 255);
+    case SizeField:
+        return QColor::fromHsv(hue, 70, 255);
+    case TypeField:
+        return QColor::fromHsv(hue, 150, 255);
+    case PayloadField:
+        return QColor::fromHsv(hue, 25, 255);
+    case PadField:
+        break;
+    }
+    return QColor(210, 210, 210);
+}
@@ -0,0 +1,61 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef HEXOVERLAY_H
+#define HEXOVERLAY_H
+
+#include <QColor>
+#include <QObject>
+#include <QTimer>
+
+#include "QHexView/qhexview.h"
+#include "chunktable.h"
+
+class TreeModel;
+
+//
+// Colours the structure of the chunks shown by the hex view: ids, size
+// fields, list types, payloads and pad bytes, with a tint per nesting
+// level. Metadata for every chunk of a large file would be far too much,
+// so only the bytes in the viewport are coloured, found by a binary search
+// per level of the tree, and the metadata is replaced whenever the view
+// scrolls, resizes or the model grows, once per pass of the event loop.
+//
+
+class HexOverlay : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HexOverlay(QHexView *view, QObject *parent = nullptr);
+
+    // the chunks shown, or nullptr to clear the overlay
+    void setModel(TreeModel *model);
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+public slots:
+    // to be called when the document of the view is replaced
+    void refresh();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    enum Field { IdField, SizeField, TypeField, PayloadField, PadField };
+
+    void updateOverlay();
+    void colourChildren(const ChunkTable &table, int32_t parent, int depth);
+    void colour(quint64 begin, quint64 end, const QColor &color);
+    static QColor fieldColor(Field field, int depth);
+
+    QHexView *m_view;
+    TreeModel *m_model{nullptr};
+    QTimer *m_timer;
+    bool m_enabled{true};
+    // the bytes in the viewport, and the ranges coloured in them
+    quint64 m_begin{0};
+    quint64 m_end{0};
+    int m_ranges{0};
+};
+
+#endif // HEXOVERLAY_H
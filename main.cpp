@@ -3,8 +3,43 @@
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QThread>
+#include <cstdio>
+#include <limits>
+#include <memory>
 
+#include "chunkdump.h"
 #include "mainwindow.h"
+#include "profiler.h"
+
+namespace {
+constexpr int MaxJobs{1024};
+
+// The dump mode must not need a display, so it is detected
+// before deciding which kind of application object to create
+bool dumpRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (qstrncmp(argv[i], "--dump", 6) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the value of an option, a whole number between minimum and maximum
+bool intValue(const QCommandLineParser &parser, const QCommandLineOption &option, int minimum, int maximum,
+              const char *name, int &value)
+{
+    bool valid = false;
+    value = parser.value(option).toInt(&valid);
+    if (!valid || value < minimum || value > maximum) {
+        std::fprintf(stderr, "Invalid %s: %s\n", name, qPrintable(parser.value(option)));
+        return false;
+    }
+    return true;
+}
+} // namespace
 
 int main(int argc, char *argv[])
 {
@@ -13,19 +48,159 @@ int main(int argc, char *argv[])
     QCoreApplication::setApplicationName(QT_STRINGIFY(PROGRAM));
     QCoreApplication::setApplicationVersion(QT_STRINGIFY(VERSION));
 
-    QApplication app(argc, argv);
+    std::unique_ptr<QCoreApplication> app(dumpRequested(argc, argv)
+                                              ? new QCoreApplication(argc, argv)
+                                              : new QApplication(argc, argv));
     QCommandLineParser parser;
     parser.addHelpOption();
     parser.addVersionOption();
     parser.addPositionalArgument("file", "RIFF file");
-    parser.process(app);
+    QCommandLineOption depthOption("expand-depth",
+                                   "Automatically expand lists up to <depth> levels.",
+                                   "depth");
+    QCommandLineOption budgetOption("expand-budget",
+                                    "Stop automatic expansion after <count> chunks.",
+                                    "count");
+    QCommandLineOption dumpOption("dump",
+                                  "Write the chunk trees of the given files and directories "
+                                  "without opening a window. <format> is text, json or csv.",
+                                  "format");
+    QCommandLineOption jobsOption("jobs",
+                                  "Number of files dumped concurrently (default: one per core).",
+                                  "count");
+    QCommandLineOption outputOption("output",
+                                    "Dump into <path>: a directory gets one file per input, "
+                                    "otherwise all the files are aggregated into one "
+                                    "(default: standard output).",
+                                    "path");
+    QCommandLineOption noCacheOption("no-cache", "Do not use the chunk index cache.");
+    QCommandLineOption mappingOption("map-budget",
+                                     "Map files larger than <MiB> a window at a time, keeping no more "
+                                     "than that mapped; 0 for no budget, the default of 64-bit builds.",
+                                     "MiB");
+    QCommandLineOption policyOption("map-policy",
+                                    "How files are read from disk on Linux: " + FileMapping::policyNames().join(", ")
+                                        + ".",
+                                    "policy");
+    QCommandLineOption traceOption("trace",
+                                   "Record the time taken by every phase and write it to <file> "
+                                   "on exit, in the Chrome trace event format.",
+                                   "file");
+    QCommandLineOption followOption("follow", "Show the chunks appended to the file while it is being written.");
+    QCommandLineOption carveOption("carve",
+                                   "Look for RIFF files embedded anywhere in the input, "
+                                   "like archives or disk images.");
+    QCommandLineOption hashOption("hash",
+                                  "With --dump, add the XXH64 hash of the data of every chunk "
+                                  "that is not a list, to find the same data in several files.");
+    QCommandLineOption queryOption("query",
+                                   "With --dump, write only the chunks matching the path <expression>, "
+                                   "like LIST(INFO)/* or RIFF(AVI )/LIST(hdrl)//strh.",
+                                   "expression");
+    parser.addOption(depthOption);
+    parser.addOption(budgetOption);
+    parser.addOption(noCacheOption);
+    parser.addOption(mappingOption);
+    parser.addOption(policyOption);
+    parser.addOption(followOption);
+    parser.addOption(carveOption);
+    parser.addOption(dumpOption);
+    parser.addOption(jobsOption);
+    parser.addOption(outputOption);
+    parser.addOption(hashOption);
+    parser.addOption(queryOption);
+    parser.addOption(traceOption);
+    parser.process(*app);
     // Retrieve command line arguments from Qt and parse options
     QStringList args = parser.positionalArguments();
+    const QString traceFile = parser.value(traceOption);
+    Profiler::setEnabled(!traceFile.isEmpty());
+    auto writeTrace = [&traceFile](int result) {
+        if (!traceFile.isEmpty() && !Profiler::exportTrace(traceFile)) {
+            std::fprintf(stderr, "Cannot write %s\n", qPrintable(traceFile));
+        }
+        return result;
+    };
+
+    if (parser.isSet(dumpOption)) {
+        ChunkDumper::Format format;
+        if (!ChunkDumper::parseFormat(parser.value(dumpOption), format)) {
+            std::fprintf(stderr, "Unknown dump format: %s\n", qPrintable(parser.value(dumpOption)));
+            return 1;
+        }
+        ChunkQuery query;
+        QString error;
+        if (parser.isSet(queryOption) && !ChunkQuery::parse(parser.value(queryOption), query, error)) {
+            std::fprintf(stderr, "Invalid query: %s\n", qPrintable(error));
+            return 1;
+        }
+        int jobs = QThread::idealThreadCount();
+        if (parser.isSet(jobsOption) && !intValue(parser, jobsOption, 1, MaxJobs, "number of jobs", jobs)) {
+            return 1;
+        }
+        return writeTrace(ChunkDumper::run(args,
+                                           format,
+                                           jobs,
+                                           parser.value(outputOption),
+                                           parser.isSet(carveOption),
+                                           parser.isSet(hashOption),
+                                           query));
+    }
+
+    qint64 mappingBudget = 0;
+    if (parser.isSet(mappingOption)) {
+        bool valid = false;
+        mappingBudget = parser.value(mappingOption).toLongLong(&valid);
+        if (!valid || mappingBudget < 0 || mappingBudget > MainWindow::MaxMappingBudget) {
+            std::fprintf(stderr, "Invalid mapping budget: %s\n", qPrintable(parser.value(mappingOption)));
+            return 1;
+        }
+    }
+    constexpr int MaxCount{std::numeric_limits<int>::max()};
+    int expandDepth = 0;
+    if (parser.isSet(depthOption) && !intValue(parser, depthOption, 0, MaxCount, "expansion depth", expandDepth)) {
+        return 1;
+    }
+    int expandBudget = 0;
+    if (parser.isSet(budgetOption)
+        && !intValue(parser, budgetOption, 0, MaxCount, "expansion budget", expandBudget)) {
+        return 1;
+    }
+    FileMapping::Policy policy = FileMapping::Default;
+    if (parser.isSet(policyOption)) {
+        bool known = false;
+        policy = FileMapping::policy(parser.value(policyOption), &known);
+        if (!known) {
+            std::fprintf(stderr, "Unknown mapping policy: %s\n", qPrintable(parser.value(policyOption)));
+            return 1;
+        }
+    }
 
     MainWindow mainwin;
+    if (parser.isSet(depthOption)) {
+        mainwin.setExpandDepth(expandDepth);
+    }
+    if (parser.isSet(budgetOption)) {
+        mainwin.setExpandBudget(expandBudget);
+    }
+    if (parser.isSet(noCacheOption)) {
+        mainwin.setCacheEnabled(false);
+    }
+    if (parser.isSet(mappingOption)) {
+        mainwin.setMappingBudget(mappingBudget);
+    }
+    if (parser.isSet(policyOption)) {
+        mainwin.setMappingPolicy(policy);
+    }
+    if (parser.isSet(followOption)) {
+        mainwin.setFollowEnabled(true);
+    }
+    if (parser.isSet(carveOption)) {
+        mainwin.setCarveEnabled(true);
+    }
     mainwin.show();
     if (args.size() > 0) {
         mainwin.openFile(args.first());
     }
-    return QCoreApplication::exec();
+    return writeTrace(QCoreApplication::exec());
 }
@@ -11,31 +11,69 @@
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QMimeData>
+#include <QProgressBar>
 #include <QScreen>
+#include <QScrollBar>
 #include <QSettings>
 #include <QStatusBar>
+#include <QVBoxLayout>
 #include <algorithm>
 
-#include "QHexView/model/buffer/qmemorybuffer.h"
+#include "QHexView/model/buffer/qdevicebuffer.h"
+#include "QHexView/model/buffer/qmappedfilebuffer.h"
 
 #include "mainwindow.h"
 #include "aboutdialog.h"
+#include "chunkcache.h"
+#include "diagnosticsdialog.h"
+#include "profiler.h"
+
+namespace {
+// the windows kept mapped of the files that could not be mapped whole,
+// when no budget was given
+constexpr qint64 DefaultWindowsBudget{qint64(1) << 30};
+} // namespace
+
+constexpr qint64 MainWindow::MaxMappingBudget;
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow{parent}
+    , m_querybox{new QueryBox(this)}
     , m_treeview{new QTreeView(this)}
     , m_hexview{new QHexView(this)}
+    , m_overlay{new HexOverlay(m_hexview, this)}
+    , m_watcher{new QFileSystemWatcher(this)}
+    , m_followTimer{new QTimer(this)}
 {
     m_treeview->setModel(m_treemodel);
     m_hexview->setDocument(m_hexdoc);
     m_hexview->setReadOnly(true);
 
+    // the query results are listed between the query and the tree
+    QWidget *treePane = new QWidget(this);
+    QVBoxLayout *treeLayout = new QVBoxLayout(treePane);
+    treeLayout->setContentsMargins(0, 0, 0, 0);
+    treeLayout->addWidget(m_querybox);
+    treeLayout->addWidget(m_treeview, 2);
+
     m_splitter = new QSplitter(this);
-    m_splitter->addWidget(m_treeview);
+    m_splitter->addWidget(treePane);
     m_splitter->addWidget(m_hexview);
     m_splitter->setSizes({333, 666});
     setCentralWidget(m_splitter);
+    // the fields of the chunk selected, decoded only while the pane is shown
+    m_details = new ChunkDetails(this);
+    m_detailsDock = new QDockWidget(tr("Chunk Details"), this);
+    m_detailsDock->setObjectName("detailsDock");
+    m_detailsDock->setWidget(m_details);
+    addDockWidget(Qt::BottomDockWidgetArea, m_detailsDock);
+    m_detailsDock->hide();
+    connect(m_detailsDock, &QDockWidget::visibilityChanged, this, &MainWindow::showChunkDetails);
     statusBar()->setSizeGripEnabled(true);
+    m_progress = new QProgressBar(this);
+    m_progress->setMaximumWidth(200);
+    m_progress->setVisible(false);
+    statusBar()->addPermanentWidget(m_progress);
 
     createActions();
     createMenus();
@@ -45,54 +83,399 @@ MainWindow::MainWindow(QWidget *parent)
     const auto screenSize = screen()->availableSize();
     resize({screenSize.width() / 2, screenSize.height() * 2 / 3});
 
+    // the watcher does not notice every change, for instance on network file
+    // systems, so the size of the file is also polled while following it
+    m_followTimer->setInterval(1000);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::checkFileSize);
+    connect(m_followTimer, &QTimer::timeout, this, &MainWindow::checkFileSize);
+
+    // the first paint after opening a file is recorded by the profiler
+    m_treeview->viewport()->installEventFilter(this);
+    m_hexview->viewport()->installEventFilter(this);
+
     connect(m_treeview, &QTreeView::clicked, this, &MainWindow::treeItemClicked);
+    connect(m_querybox, &QueryBox::chunkActivated, this, &MainWindow::showHit);
+    connect(m_hexview, &QHexView::positionChanged, this, &MainWindow::hexPositionChanged);
     updateWindowTitle();
     readSettings();
 }
 
 void MainWindow::openFile(const QString fileName)
 {
-    QFile file(fileName);
-    bool Ok = file.open(QIODevice::ReadOnly);
+    ProfileScope scope("open file");
+    m_openStart = Profiler::isEnabled() ? Profiler::now() : 0;
+    auto file = std::make_unique<QFile>(fileName);
+    bool Ok = file->open(QIODevice::ReadOnly);
     if (Ok) {
-        // QFile::map doesn't allow options like MAP_HUGETLB, MAP_PRIVATE or MAP_LOCKED
-        // but it is more portable between different operating systems than mmap().
-        // Previously, we tried to use MAP_HUGETLB with mmap() syscall but it is only
-        // valid for anonymous memory.
-        uint8_t *buffer = file.map(0, file.size());
+        // QFile::map doesn't allow options like MAP_POPULATE or MAP_LOCKED, so
+        // on Linux the file is mapped with mmap() by FileMapping, following the
+        // mapping policy. MAP_HUGETLB is only valid for anonymous memory.
+        // Files larger than the mapping budget, or that do not fit in the
+        // address space, are read a window at a time instead.
+        uint8_t *buffer = nullptr;
+        std::unique_ptr<FileWindows> windows;
+        if (m_mappingBudget == 0 || file->size() <= m_mappingBudget) {
+            ProfileScope mapScope("map file");
+            mapScope.setArg(0, "bytes", file->size());
+            mapScope.setArg(1, "policy", m_mappingPolicy);
+            buffer = FileMapping::map(*file, file->size(), m_mappingPolicy);
+        }
         if (buffer == nullptr) {
-            QMessageBox::warning(this, qApp->applicationName(), file.errorString());
-            file.close();
-            return;
+            windows = std::make_unique<FileWindows>(fileName,
+                                                    m_mappingBudget > 0 ? m_mappingBudget : DefaultWindowsBudget);
+            if (!windows->open()) {
+                QMessageBox::warning(this, qApp->applicationName(), windows->errorString());
+                return;
+            }
         }
 
-        delete m_treemodel;
+        closeFile();
+        m_file = std::move(file);
+        m_windows = std::move(windows);
+        m_buffer = buffer;
+        m_mappedSize = m_file->size();
         m_treemodel = new TreeModel(this);
 
         m_treeview->setModel(m_treemodel);
         m_treeview->setSelectionMode(QAbstractItemView::SingleSelection);
+        connect(m_treeview->selectionModel(),
+                &QItemSelectionModel::currentChanged,
+                this,
+                &MainWindow::showChunkDetails);
         m_treeview->setColumnWidth(0, 100);
         m_treeview->setColumnWidth(1, 66);
         m_treeview->setColumnWidth(2, 66);
-        m_hexview->setDocument(nullptr);
-
-        if (m_treemodel->loadData(buffer)) {
-            m_hexdoc = QHexDocument::fromMemory<QMemoryBuffer>(reinterpret_cast<char *>(buffer),
-                                                               file.size());
-            m_hexview->setDocument(m_hexdoc);
-            m_treeview->expandAll();
-            m_treeview->resizeColumnToContents(0);
+        updateHashColumns();
+
+        connect(m_treemodel, &QAbstractItemModel::rowsInserted, this, &MainWindow::chunksInserted);
+        connect(m_treemodel, &TreeModel::loadProgress, this, &MainWindow::loadProgress);
+        connect(m_treemodel, &TreeModel::loadFinished, this, &MainWindow::loadFinished);
+
+        // the index cache holds the trees read from the start of the files
+        ChunkTable cached;
+        const bool fromCache = m_buffer != nullptr && m_useCache && !m_carve
+                               && ChunkCache(ChunkCache::defaultDirectory(), m_cacheLimit)
+                                      .load(fileName, m_buffer, m_mappedSize, cached);
+        const bool loaded = m_windows ? m_treemodel->loadWindows(m_windows.get())
+                                      : m_treemodel->loadData(m_buffer, m_mappedSize, fromCache ? &cached : nullptr, m_carve);
+        if (loaded) {
+            m_filePath = fileName;
+            FileMapping::advise(m_buffer,
+                                m_mappedSize,
+                                m_mappingPolicy,
+                                m_treemodel->isLoading() ? FileMapping::Sequential : FileMapping::Random);
+            openHexDocument();
+            m_overlay->setModel(m_treemodel);
+            m_querybox->setModel(m_treemodel);
+            if (m_searchDialog != nullptr) {
+                m_searchDialog->setFile(m_buffer, m_mappedSize, m_treemodel);
+            }
+            if (m_duplicatesDialog != nullptr) {
+                m_duplicatesDialog->setFile(m_buffer, m_mappedSize, m_carve);
+            }
+            if (m_statisticsDialog != nullptr) {
+                m_statisticsDialog->setFile(m_buffer, m_mappedSize, m_carve);
+            }
+            m_expandedRows = 0;
+            m_openPending = true;
+            m_treePainted = false;
+            m_hexPainted = false;
+            {
+                ProfileScope expandScope("expand");
+                const QModelIndex root = m_treemodel->index(0, 0);
+                m_treeview->expand(root);
+                expandChildren(root, 0, m_treemodel->rowCount(root) - 1);
+            }
+            if (fromCache) {
+                m_treeview->resizeColumnToContents(0);
+                statusBar()->showMessage(tr("%1 chunks from the index cache").arg(m_treemodel->chunkCount()));
+            } else if (m_windows) {
+                // searches, hashes, statistics and details need the whole mapping
+                statusBar()->showMessage(tr("Reading the file in windows of %1 MiB, within %2 MiB")
+                                             .arg(FileWindows::WindowSize / (1024 * 1024))
+                                             .arg(m_windows->budget() / (1024 * 1024)));
+            }
 
             m_openFileName = QFileInfo(fileName).fileName();
             updateWindowTitle();
+            if (m_follow) {
+                m_watcher->addPath(m_filePath);
+                m_followTimer->start();
+            }
+        } else if (m_carve && !m_windows) {
+            QMessageBox::warning(this,
+                                 qApp->applicationName(),
+                                 tr("No RIFF files were found inside %1").arg(fileName));
+            closeFile();
         } else {
             QMessageBox::warning(this,
                                  qApp->applicationName(),
                                  tr("%1 is not a valid RIFF file").arg(fileName));
+            closeFile();
+        }
+    }
+}
+
+void MainWindow::openHexDocument()
+{
+    // The hex document reads straight from its own mapping of the file,
+    // sharing the page cache with the tree model instead of copying the
+    // whole file into the heap, or reads the rows shown from the file when
+    // it is too large to be mapped. The buffer takes ownership of the device.
+    ProfileScope scope("hex document");
+    QHexDocument *previous = m_hexdoc;
+    m_hexdoc = nullptr;
+    auto *device = new QFile(m_filePath);
+    if (device->open(QIODevice::ReadOnly)) {
+        m_hexdoc = m_windows ? QHexDocument::fromDevice<QDeviceBuffer>(device, this)
+                             : QHexDocument::fromDevice<QMappedFileBuffer>(device, this);
+    } else {
+        delete device;
+    }
+    m_hexview->setDocument(m_hexdoc);
+    m_overlay->refresh();
+    delete previous;
+}
+
+void MainWindow::checkFileSize()
+{
+    // files read a window at a time are not followed, growing would take
+    // mapping the whole file
+    if (!m_follow || !m_file || m_windows || m_treemodel == nullptr) {
+        return;
+    }
+    // the watcher stops watching files that are replaced
+    if (!m_watcher->files().contains(m_filePath)) {
+        m_watcher->addPath(m_filePath);
+    }
+    const qint64 size = m_file->size();
+    if (size <= m_mappedSize) {
+        return;
+    }
+    // The file is mapped again with its new size and only the chunks that
+    // were appended are read, the rows already in the tree are kept.
+    uint8_t *buffer = FileMapping::map(*m_file, size, m_mappingPolicy);
+    if (buffer == nullptr) {
+        return;
+    }
+    FileMapping::advise(buffer, size, m_mappingPolicy, FileMapping::Sequential);
+    if (!m_treemodel->extend(buffer, size)) {
+        FileMapping::unmap(*m_file, buffer, size);
+        return;
+    }
+    if (m_searchDialog != nullptr) {
+        m_searchDialog->setFile(buffer, size, m_treemodel);
+    }
+    if (m_duplicatesDialog != nullptr) {
+        m_duplicatesDialog->setFile(buffer, size, m_carve);
+    }
+    if (m_statisticsDialog != nullptr) {
+        m_statisticsDialog->setFile(buffer, size, m_carve);
+    }
+    m_details->clear();
+    FileMapping::unmap(*m_file, m_buffer, m_mappedSize);
+    m_buffer = buffer;
+    m_mappedSize = size;
+    showChunkDetails();
+
+    const int scrollPosition = m_hexview->verticalScrollBar()->value();
+    openHexDocument();
+    m_hexview->verticalScrollBar()->setValue(scrollPosition);
+    if (!m_treemodel->isLoading()) {
+        statusBar()->showMessage(tr("%1 chunks, %2 bytes").arg(m_treemodel->chunkCount()).arg(m_mappedSize));
+    }
+}
+
+void MainWindow::chunksInserted(const QModelIndex &parent, int first, int last)
+{
+    expandChildren(parent, first, last);
+}
+
+void MainWindow::expandChildren(const QModelIndex &parent, int first, int last)
+{
+    // Lists are expanded automatically, which scans their children, only
+    // up to the configured depth and while the rows shown this way do not
+    // exceed the configured budget.
+    if (!parent.isValid() || first > last) {
+        return;
+    }
+    int depth = 1;
+    for (QModelIndex p = parent; p.parent().isValid(); p = p.parent()) {
+        ++depth;
+    }
+    if (depth >= m_expandDepth) {
+        return;
+    }
+    m_expandedRows += last - first + 1;
+    for (int row = first; row <= last && m_expandedRows < m_expandBudget; ++row) {
+        const QModelIndex index = m_treemodel->index(row, 0, parent);
+        if (m_treemodel->hasChildren(index)) {
+            m_treeview->expand(index);
+            // children restored from the index cache are already there
+            expandChildren(index, 0, m_treemodel->rowCount(index) - 1);
         }
+    }
+}
+
+void MainWindow::loadProgress(qint64 done, qint64 total)
+{
+    // QProgressBar takes int values, so the range is expressed in per mille
+    m_progress->setRange(0, 1000);
+    m_progress->setValue(total > 0 ? int(done * 1000 / total) : 0);
+    m_progress->setVisible(true);
+    cancelAct->setEnabled(true);
+    statusBar()->showMessage(tr("Scanning... %1 chunks").arg(m_treemodel->chunkCount()));
+}
+
+void MainWindow::loadFinished(bool completed)
+{
+    // the rest of the file is read where the tree is browsed
+    FileMapping::advise(m_buffer, m_mappedSize, m_mappingPolicy, FileMapping::Random);
+    m_progress->setVisible(false);
+    cancelAct->setEnabled(false);
+    {
+        ProfileScope scope("resize columns");
+        m_treeview->resizeColumnToContents(0);
+    }
+    Profiler::addCounter("chunks", m_treemodel->chunkCount());
+    Profiler::addCounter("table bytes", qint64(m_treemodel->chunks().memoryUsage()));
+    Profiler::addCounter("mapped bytes", m_mappedSize);
+    const bool opened = m_openPending;
+    m_openPending = false;
+    if (completed && opened && Profiler::isEnabled() && m_openStart > 0) {
+        statusBar()->showMessage(tr("%1 chunks, %2 KiB, loaded in %3 ms")
+                                     .arg(m_treemodel->chunkCount())
+                                     .arg(m_treemodel->chunks().memoryUsage() / 1024)
+                                     .arg((Profiler::now() - m_openStart) / 1000000));
+    } else if (completed) {
+        statusBar()->showMessage(tr("%1 chunks, %2 KiB")
+                                     .arg(m_treemodel->chunkCount())
+                                     .arg(m_treemodel->chunks().memoryUsage() / 1024));
+    } else {
+        statusBar()->showMessage(tr("Scan cancelled after %1 chunks").arg(m_treemodel->chunkCount()));
+    }
+}
+
+void MainWindow::setExpandDepth(int depth)
+{
+    m_expandDepth = depth;
+    m_sessionOnly.insert("expandDepth");
+}
+
+void MainWindow::setExpandBudget(int budget)
+{
+    m_expandBudget = budget;
+    m_sessionOnly.insert("expandBudget");
+}
+
+void MainWindow::setCacheEnabled(bool enabled)
+{
+    m_useCache = enabled;
+    cacheAct->setChecked(enabled);
+    m_sessionOnly.insert("indexCache");
+}
+
+void MainWindow::setCarveEnabled(bool enabled)
+{
+    const bool changed = enabled != m_carve;
+    m_carve = enabled;
+    carveAct->setChecked(enabled);
+    // the file open is read again the other way
+    if (changed && m_file) {
+        openFile(m_file->fileName());
+    }
+}
+
+void MainWindow::setMappingBudget(qint64 megabytes)
+{
+    // files already open keep the way they were read
+    m_mappingBudget = qBound(qint64(0), megabytes, MaxMappingBudget) * 1024 * 1024;
+    m_sessionOnly.insert("mappingBudget");
+}
 
-        file.unmap(buffer);
-        file.close();
+void MainWindow::setMappingPolicy(FileMapping::Policy policy)
+{
+    // the mapping of the file open keeps the way it was made, the hints follow
+    m_mappingPolicy = policy;
+    m_sessionOnly.insert("mappingPolicy");
+}
+
+void MainWindow::setOverlayEnabled(bool enabled)
+{
+    overlayAct->setChecked(enabled);
+    m_overlay->setEnabled(enabled);
+}
+
+void MainWindow::setFollowEnabled(bool enabled)
+{
+    m_follow = enabled;
+    followAct->setChecked(enabled);
+    m_sessionOnly.insert("followFile");
+    if (!m_file) {
+        return;
+    }
+    if (enabled) {
+        m_watcher->addPath(m_filePath);
+        m_followTimer->start();
+        checkFileSize();
+    } else {
+        m_watcher->removePath(m_filePath);
+        m_followTimer->stop();
+    }
+}
+
+void MainWindow::cancelScan()
+{
+    if (m_treemodel != nullptr) {
+        m_treemodel->cancelLoading();
+    }
+}
+
+void MainWindow::closeFile()
+{
+    // save the chunks scanned in this session for the next time the file is opened
+    if (m_useCache && m_treemodel != nullptr && m_treemodel->isModified() && !m_treemodel->isCarved()
+        && m_buffer != nullptr) {
+        ChunkCache(ChunkCache::defaultDirectory(), m_cacheLimit)
+            .store(m_filePath, m_buffer, m_mappedSize, m_treemodel->chunks());
+    }
+    m_followTimer->stop();
+    if (!m_watcher->files().isEmpty()) {
+        m_watcher->removePaths(m_watcher->files());
+    }
+    // the model, the hex document and the searches must go away before the
+    // mapping they read from
+    if (m_searchDialog != nullptr) {
+        m_searchDialog->setFile(nullptr, 0, nullptr);
+    }
+    if (m_duplicatesDialog != nullptr) {
+        m_duplicatesDialog->setFile(nullptr, 0, false);
+    }
+    if (m_statisticsDialog != nullptr) {
+        m_statisticsDialog->setFile(nullptr, 0, false);
+    }
+    m_querybox->setModel(nullptr);
+    m_overlay->setModel(nullptr);
+    m_details->clear();
+    m_treeview->setModel(nullptr);
+    delete m_treemodel;
+    m_treemodel = nullptr;
+    m_hexview->setDocument(nullptr);
+    delete m_hexdoc;
+    m_hexdoc = nullptr;
+    // after the model, whose scanners read from them
+    m_windows.reset();
+    m_progress->setVisible(false);
+    cancelAct->setEnabled(false);
+    statusBar()->clearMessage();
+    if (m_file) {
+        if (m_buffer != nullptr) {
+            FileMapping::unmap(*m_file, m_buffer, m_mappedSize);
+            m_buffer = nullptr;
+        }
+        m_mappedSize = 0;
+        m_file->close();
+        m_file.reset();
     }
 }
 
@@ -104,7 +487,7 @@ void MainWindow::open()
         tr("Open File"),
         m_openFileName,
         tr("All Files (*);;Riff Files (*.dls *.sf2 *.sf3 *.avi *.wav "
-           "*.rmi *.cdr *.ani *.pal *.webp)"),
+           "*.rf64 *.bw64 *.rmi *.cdr *.ani *.pal *.webp *.aif *.aiff *.aifc *.iff)"),
         &selectedFilter,
         QFileDialog::ReadOnly);
     if (!fileName.isEmpty()) {
@@ -133,6 +516,8 @@ void MainWindow::retranslate()
     languageMenu->setTitle(tr("&Language"));
     openAct->setText(tr("&Open..."));
     openAct->setStatusTip(tr("Open an existing file"));
+    cancelAct->setText(tr("&Cancel Scan"));
+    cancelAct->setStatusTip(tr("Stop scanning the current file"));
     exitAct->setText(tr("E&xit"));
     exitAct->setStatusTip(tr("Exit the application"));
     aboutAct->setText(tr("&About"));
@@ -141,6 +526,28 @@ void MainWindow::retranslate()
     aboutQtAct->setStatusTip(tr("Show the Qt library's About box"));
     findAct->setText(tr("Find..."));
     findAct->setStatusTip(tr("Show the Find dialog"));
+    searchAct->setText(tr("&Search File..."));
+    searchAct->setStatusTip(tr("Find every occurrence of a pattern in the file"));
+    duplicatesAct->setText(tr("&Duplicate Chunks..."));
+    duplicatesAct->setStatusTip(tr("Find the chunks of the file holding the same data"));
+    statisticsAct->setText(tr("File S&tatistics..."));
+    statisticsAct->setStatusTip(tr("Show the count and size of every kind of chunk in the file"));
+    m_detailsDock->setWindowTitle(tr("Chunk Details"));
+    detailsAct->setStatusTip(tr("Show the fields of the selected chunk"));
+    hashAct->setText(tr("Show Payload &Hashes"));
+    hashAct->setStatusTip(tr("Show the XXH64 hash of the data of every chunk"));
+    crc32Act->setText(tr("Show CRC&32"));
+    crc32Act->setStatusTip(tr("Show the CRC-32 of the data of every chunk"));
+    overlayAct->setText(tr("Show Chunk &Structure"));
+    overlayAct->setStatusTip(tr("Colour the ids, sizes and data of the chunks in the hex view"));
+    cacheAct->setText(tr("Use Index &Cache"));
+    cacheAct->setStatusTip(tr("Remember the chunks of the files opened recently"));
+    followAct->setText(tr("&Follow File"));
+    followAct->setStatusTip(tr("Show the chunks appended to the file while it is being written"));
+    carveAct->setText(tr("C&arve Embedded Files"));
+    carveAct->setStatusTip(tr("Show the RIFF files found anywhere inside archives and disk images"));
+    diagnosticsAct->setText(tr("&Diagnostics..."));
+    diagnosticsAct->setStatusTip(tr("Show the time taken by opening and scanning files"));
 }
 
 void MainWindow::readSettings()
@@ -161,6 +568,20 @@ void MainWindow::readSettings()
     if (it != lngActions.end()) {
         (*it)->setChecked(true);
     }
+    m_expandDepth = settings.value("expandDepth", m_expandDepth).toInt();
+    m_expandBudget = settings.value("expandBudget", m_expandBudget).toInt();
+    m_cacheLimit = settings.value("indexCacheLimit", m_cacheLimit / (1024 * 1024)).toLongLong() * 1024 * 1024;
+    setMappingBudget(settings.value("mappingBudget", m_mappingBudget / (1024 * 1024)).toLongLong());
+    setMappingPolicy(FileMapping::policy(
+        settings.value("mappingPolicy", FileMapping::policyName(m_mappingPolicy)).toString()));
+    setCacheEnabled(settings.value("indexCache", m_useCache).toBool());
+    setFollowEnabled(settings.value("followFile", m_follow).toBool());
+    hashAct->setChecked(settings.value("hashColumn", false).toBool());
+    crc32Act->setChecked(settings.value("crc32Column", false).toBool());
+    overlayAct->setChecked(settings.value("structureOverlay", true).toBool());
+    m_detailsDock->setVisible(settings.value("detailsPane", false).toBool());
+    // only what is set after this is for the session
+    m_sessionOnly.clear();
     retranslate();
 }
 
@@ -182,23 +603,158 @@ void MainWindow::about()
     dlg.exec();
 }
 
+void MainWindow::diagnostics()
+{
+    DiagnosticsDialog dlg(this);
+    dlg.exec();
+}
+
+void MainWindow::searchFile()
+{
+    // not modal, so that the hits can be browsed along with the tree
+    if (m_searchDialog == nullptr) {
+        m_searchDialog = new SearchDialog(m_treeview, this);
+        m_searchDialog->setFile(m_buffer, m_mappedSize, m_treemodel);
+        connect(m_searchDialog, &SearchDialog::hitActivated, this, &MainWindow::showHit);
+    }
+    m_searchDialog->show();
+    m_searchDialog->raise();
+    m_searchDialog->activateWindow();
+}
+
+void MainWindow::findDuplicates()
+{
+    if (m_duplicatesDialog == nullptr) {
+        m_duplicatesDialog = new DuplicatesDialog(this);
+        m_duplicatesDialog->setFile(m_buffer, m_mappedSize, m_carve);
+        connect(m_duplicatesDialog, &DuplicatesDialog::chunkActivated, this, &MainWindow::showHit);
+    }
+    m_duplicatesDialog->show();
+    m_duplicatesDialog->raise();
+    m_duplicatesDialog->activateWindow();
+}
+
+void MainWindow::showStatistics()
+{
+    if (m_statisticsDialog == nullptr) {
+        m_statisticsDialog = new StatisticsDialog(this);
+        m_statisticsDialog->setFile(m_buffer, m_mappedSize, m_carve);
+    }
+    m_statisticsDialog->show();
+    m_statisticsDialog->raise();
+    m_statisticsDialog->activateWindow();
+    m_statisticsDialog->refresh();
+}
+
+void MainWindow::showChunkDetails()
+{
+    if (!m_detailsDock->isVisible()) {
+        return;
+    }
+    const QModelIndex index = m_treeview->currentIndex();
+    if (m_treemodel == nullptr || m_buffer == nullptr || !index.isValid()) {
+        m_details->clear();
+        return;
+    }
+    // RIFX and IFF files store their fields big endian, like their sizes
+    m_details->setChunk(m_buffer,
+                        m_mappedSize,
+                        m_treemodel->chunks(),
+                        m_treemodel->nodeOf(index),
+                        m_treemodel->format() != RiffScanner::Format::Riff);
+}
+
+void MainWindow::updateHashColumns()
+{
+    // hidden columns are never painted, so their hashes are not computed
+    m_treeview->setColumnHidden(TreeModel::HashColumn, !hashAct->isChecked());
+    m_treeview->setColumnHidden(TreeModel::Crc32Column, !crc32Act->isChecked());
+    if (m_treemodel != nullptr && hashAct->isChecked()) {
+        m_treeview->resizeColumnToContents(TreeModel::HashColumn);
+    }
+}
+
+void MainWindow::showHit(qint64 offset, qint64 length)
+{
+    if (m_hexdoc == nullptr) {
+        return;
+    }
+    FileMapping::prefetch(m_buffer, m_mappedSize, m_mappingPolicy, offset, length);
+    m_selectingChunk = true;
+    m_hexview->hexCursor()->clearSelection();
+    m_hexview->hexCursor()->move(offset);
+    m_hexview->hexCursor()->select(offset);
+    m_hexview->hexCursor()->selectSize(length);
+    m_hexview->update();
+    m_selectingChunk = false;
+    selectChunkAt(offset);
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    // the time from opening a file to the first paint of each view
+    if (event->type() == QEvent::Paint && Profiler::isEnabled() && m_openStart > 0) {
+        const char *const argNames[2]{nullptr, nullptr};
+        const qint64 argValues[2]{0, 0};
+        if (watched == m_treeview->viewport() && !m_treePainted) {
+            m_treePainted = true;
+            Profiler::addSpan("first tree paint", m_openStart, argNames, argValues);
+        } else if (watched == m_hexview->viewport() && !m_hexPainted) {
+            m_hexPainted = true;
+            Profiler::addSpan("first hex paint", m_openStart, argNames, argValues);
+        }
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
 void MainWindow::treeItemClicked(const QModelIndex &index)
 {
-    // QString title = m_treemodel->data(index.sibling(index.row(), 0), Qt::DisplayRole).toString();
-    qint64 offs = m_treemodel->data(index.sibling(index.row(), 1), Qt::DisplayRole).toLongLong();
-    qint64 size = m_treemodel->data(index.sibling(index.row(), 2), Qt::DisplayRole).toLongLong()
-                  + 2 * sizeof(uint32_t);
+    if (m_treemodel == nullptr || !index.isValid()) {
+        return;
+    }
+    // the chunk of the row, whatever column was clicked and wherever it is
+    const ChunkNode &node = m_treemodel->chunks().node(m_treemodel->nodeOf(index));
+    const qint64 offs = qint64(node.offset);
+    const qint64 size = qint64(node.size) + RiffScanner::HeaderSize;
 
     // qDebug() << Q_FUNC_INFO << title << "offset:" << offs << "size:" << size;
     // m_hexview->clearMetadata();
     // m_hexview->hexCursor()->move(offs);
     // m_hexview->setMetadata(offs, offs + size, Qt::black, Qt::yellow, title);
 
+    // the bytes of the chunk are read from the disk while the views change
+    FileMapping::prefetch(m_buffer, m_mappedSize, m_mappingPolicy, offs, size);
+
+    // the selection leaves the cursor at the end of the chunk, which must
+    // not move the tree selection away from the row clicked
+    m_selectingChunk = true;
     m_hexview->hexCursor()->clearSelection();
     m_hexview->hexCursor()->move(offs);
     m_hexview->hexCursor()->select(offs);
     m_hexview->hexCursor()->selectSize(size);
     m_hexview->update();
+    m_selectingChunk = false;
+}
+
+void MainWindow::hexPositionChanged()
+{
+    if (!m_selectingChunk && m_hexdoc != nullptr) {
+        selectChunkAt(m_hexview->hexCursor()->offset());
+    }
+}
+
+void MainWindow::selectChunkAt(qint64 offset)
+{
+    if (m_treemodel == nullptr) {
+        return;
+    }
+    // a binary search per tree level, cheap enough for every cursor move
+    const QModelIndex index = m_treemodel->indexAt(offset);
+    if (!index.isValid() || index == m_treeview->currentIndex()) {
+        return;
+    }
+    m_treeview->setCurrentIndex(index);
+    m_treeview->scrollTo(index);
 }
 
 void MainWindow::createActions()
@@ -213,6 +769,17 @@ void MainWindow::createActions()
     openAct->setStatusTip(tr("Open an existing file"));
     connect(openAct, &QAction::triggered, this, &MainWindow::open);
 
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    QIcon cancelIcon = QIcon::fromTheme("process-stop");
+#else
+    QIcon cancelIcon = QIcon::fromTheme(QIcon::ThemeIcon::ProcessStop);
+#endif
+    cancelAct = new QAction(cancelIcon, tr("&Cancel Scan"), this);
+    cancelAct->setShortcuts(QKeySequence::Cancel);
+    cancelAct->setStatusTip(tr("Stop scanning the current file"));
+    cancelAct->setEnabled(false);
+    connect(cancelAct, &QAction::triggered, this, &MainWindow::cancelScan);
+
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     QIcon exitIcon = QIcon::fromTheme("application-exit");
 #else
@@ -245,17 +812,90 @@ void MainWindow::createActions()
     findAct = new QAction(findIcon, tr("Find..."), this);
     findAct->setStatusTip(tr("Show the Find dialog"));
     connect(findAct, &QAction::triggered, m_hexview, &QHexView::showFind);
+
+    searchAct = new QAction(findIcon, tr("&Search File..."), this);
+    searchAct->setShortcut(QKeySequence(QStringLiteral("Ctrl+Shift+F")));
+    searchAct->setStatusTip(tr("Find every occurrence of a pattern in the file"));
+    connect(searchAct, &QAction::triggered, this, &MainWindow::searchFile);
+
+    duplicatesAct = new QAction(tr("&Duplicate Chunks..."), this);
+    duplicatesAct->setStatusTip(tr("Find the chunks of the file holding the same data"));
+    connect(duplicatesAct, &QAction::triggered, this, &MainWindow::findDuplicates);
+
+    statisticsAct = new QAction(tr("File S&tatistics..."), this);
+    statisticsAct->setStatusTip(tr("Show the count and size of every kind of chunk in the file"));
+    connect(statisticsAct, &QAction::triggered, this, &MainWindow::showStatistics);
+
+    detailsAct = m_detailsDock->toggleViewAction();
+    detailsAct->setStatusTip(tr("Show the fields of the selected chunk"));
+
+    hashAct = new QAction(tr("Show Payload &Hashes"), this);
+    hashAct->setStatusTip(tr("Show the XXH64 hash of the data of every chunk"));
+    hashAct->setCheckable(true);
+    connect(hashAct, &QAction::toggled, this, &MainWindow::updateHashColumns);
+
+    crc32Act = new QAction(tr("Show CRC&32"), this);
+    crc32Act->setStatusTip(tr("Show the CRC-32 of the data of every chunk"));
+    crc32Act->setCheckable(true);
+    connect(crc32Act, &QAction::toggled, this, &MainWindow::updateHashColumns);
+
+    overlayAct = new QAction(tr("Show Chunk &Structure"), this);
+    overlayAct->setStatusTip(tr("Colour the ids, sizes and data of the chunks in the hex view"));
+    overlayAct->setCheckable(true);
+    overlayAct->setChecked(m_overlay->isEnabled());
+    connect(overlayAct, &QAction::toggled, m_overlay, &HexOverlay::setEnabled);
+
+    cacheAct = new QAction(tr("Use Index &Cache"), this);
+    cacheAct->setStatusTip(tr("Remember the chunks of the files opened recently"));
+    cacheAct->setCheckable(true);
+    cacheAct->setChecked(m_useCache);
+    // triggered by the user only, the choice is saved
+    connect(cacheAct, &QAction::triggered, this, [this](bool checked) {
+        setCacheEnabled(checked);
+        m_sessionOnly.remove("indexCache");
+    });
+
+    followAct = new QAction(tr("&Follow File"), this);
+    followAct->setStatusTip(tr("Show the chunks appended to the file while it is being written"));
+    followAct->setCheckable(true);
+    followAct->setChecked(m_follow);
+    connect(followAct, &QAction::triggered, this, [this](bool checked) {
+        setFollowEnabled(checked);
+        m_sessionOnly.remove("followFile");
+    });
+
+    carveAct = new QAction(tr("C&arve Embedded Files"), this);
+    carveAct->setStatusTip(tr("Show the RIFF files found anywhere inside archives and disk images"));
+    carveAct->setCheckable(true);
+    carveAct->setChecked(m_carve);
+    connect(carveAct, &QAction::toggled, this, &MainWindow::setCarveEnabled);
+
+    diagnosticsAct = new QAction(tr("&Diagnostics..."), this);
+    diagnosticsAct->setStatusTip(tr("Show the time taken by opening and scanning files"));
+    connect(diagnosticsAct, &QAction::triggered, this, &MainWindow::diagnostics);
 }
 
 void MainWindow::createMenus()
 {
     fileMenu = menuBar()->addMenu(tr("&File"));
     fileMenu->addAction(openAct);
+    fileMenu->addAction(cancelAct);
+    fileMenu->addAction(followAct);
+    fileMenu->addAction(carveAct);
     fileMenu->addSeparator();
     fileMenu->addAction(exitAct);
 
     editMenu = menuBar()->addMenu(tr("&Edit"));
     editMenu->addAction(findAct);
+    editMenu->addAction(searchAct);
+    editMenu->addAction(duplicatesAct);
+    editMenu->addAction(statisticsAct);
+    editMenu->addAction(detailsAct);
+    editMenu->addSeparator();
+    editMenu->addAction(hashAct);
+    editMenu->addAction(crc32Act);
+    editMenu->addAction(overlayAct);
+    editMenu->addAction(cacheAct);
 
     helpMenu = menuBar()->addMenu(tr("&Help"));
 
@@ -275,6 +915,7 @@ void MainWindow::createMenus()
     connect(languageGroup, &QActionGroup::triggered, this, &MainWindow::changeLanguage);
 
     languageMenu->addActions(languageGroup->actions());
+    helpMenu->addAction(diagnosticsAct);
     helpMenu->addSeparator();
     helpMenu->addAction(aboutAct);
     helpMenu->addAction(aboutQtAct);
@@ -289,11 +930,12 @@ void MainWindow::dragEnterEvent(QDragEnterEvent *event)
 
 void MainWindow::dropEvent(QDropEvent *event)
 {
-    QStringList types{"dls", "sf2", "sf3", "avi", "wav", "rmi", "cdr", "ani", "pal", "webp"};
+    QStringList types{"dls", "sf2", "sf3", "avi", "wav", "rf64", "bw64", "rmi",
+                      "cdr", "ani", "pal", "webp", "aif", "aiff", "aifc", "iff"};
     foreach (const QUrl &url, event->mimeData()->urls()) {
         QString fname = url.toLocalFile();
         QFileInfo info(fname);
-        if (info.exists() && types.contains(info.suffix().trimmed(), Qt::CaseInsensitive)) {
+        if (info.exists() && (m_carve || types.contains(info.suffix().trimmed(), Qt::CaseInsensitive))) {
             openFile(fname);
         }
     }
@@ -301,8 +943,26 @@ void MainWindow::dropEvent(QDropEvent *event)
 
 void MainWindow::closeEvent(QCloseEvent *event)
 {
+    closeFile();
     QSettings settings;
     settings.setValue("geometry", saveGeometry());
     settings.setValue("language", m_currentLang);
+    // the values of the command line leave the saved ones alone
+    auto save = [&](const QString &key, const QVariant &value) {
+        if (!m_sessionOnly.contains(key)) {
+            settings.setValue(key, value);
+        }
+    };
+    save("expandDepth", m_expandDepth);
+    save("expandBudget", m_expandBudget);
+    save("indexCache", m_useCache);
+    save("followFile", m_follow);
+    settings.setValue("hashColumn", hashAct->isChecked());
+    settings.setValue("crc32Column", crc32Act->isChecked());
+    settings.setValue("structureOverlay", overlayAct->isChecked());
+    settings.setValue("detailsPane", m_detailsDock->isVisible());
+    settings.setValue("indexCacheLimit", m_cacheLimit / (1024 * 1024));
+    save("mappingBudget", m_mappingBudget / (1024 * 1024));
+    save("mappingPolicy", FileMapping::policyName(m_mappingPolicy));
     QMainWindow::closeEvent(event);
 }
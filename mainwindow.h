@@ -6,15 +6,30 @@
 
 #include <QAction>
 #include <QCloseEvent>
+#include <QDockWidget>
 #include <QDragEnterEvent>
 #include <QDropEvent>
+#include <QFile>
+#include <QFileSystemWatcher>
 #include <QMainWindow>
 #include <QMenu>
+#include <QProgressBar>
+#include <QSet>
 #include <QSplitter>
+#include <QTimer>
 #include <QTranslator>
 #include <QTreeView>
+#include <memory>
 
 #include "QHexView/qhexview.h"
+#include "chunkdetails.h"
+#include "duplicatesdialog.h"
+#include "filemapping.h"
+#include "filewindows.h"
+#include "hexoverlay.h"
+#include "querybox.h"
+#include "searchdialog.h"
+#include "statisticsdialog.h"
 #include "treemodel.h"
 
 class MainWindow : public QMainWindow
@@ -23,8 +38,21 @@ class MainWindow : public QMainWindow
 public:
     explicit MainWindow(QWidget *parent = nullptr);
     void openFile(const QString fileName);
+    // the options set here, like from the command line, last for this
+    // session only; the settings keep what was chosen from the menus
+    void setExpandDepth(int depth);
+    void setExpandBudget(int budget);
+    void setCacheEnabled(bool enabled);
+    void setFollowEnabled(bool enabled);
+    void setCarveEnabled(bool enabled);
+    void setOverlayEnabled(bool enabled);
+    // files larger than this are read a window at a time, 0 for no budget
+    void setMappingBudget(qint64 megabytes);
+    static constexpr qint64 MaxMappingBudget{qint64(1) << 30}; // MiB
+    void setMappingPolicy(FileMapping::Policy policy);
 
 protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
     void dragEnterEvent(QDragEnterEvent *event) override;
     void dropEvent(QDropEvent *event) override;
     void closeEvent(QCloseEvent *event) override;
@@ -32,35 +60,97 @@ protected:
 private slots:
     void open();
     void about();
+    void diagnostics();
+    void searchFile();
+    void findDuplicates();
+    void showStatistics();
+    void showChunkDetails();
+    void updateHashColumns();
+    void showHit(qint64 offset, qint64 length);
     void treeItemClicked(const QModelIndex &index);
+    void hexPositionChanged();
     void updateWindowTitle();
     void changeLanguage(QAction *action);
+    void chunksInserted(const QModelIndex &parent, int first, int last);
+    void loadProgress(qint64 done, qint64 total);
+    void loadFinished(bool completed);
+    void cancelScan();
+    void checkFileSize();
 
 private:
     void createActions();
     void createMenus();
     void retranslate();
     void readSettings();
+    void closeFile();
+    void openHexDocument();
+    void expandChildren(const QModelIndex &parent, int first, int last);
+    void selectChunkAt(qint64 offset);
 
     QMenu *editMenu;
     QMenu *fileMenu;
     QMenu *helpMenu;
     QMenu *languageMenu;
     QAction *openAct;
+    QAction *cancelAct;
     QAction *exitAct;
     QAction *aboutAct;
     QAction *aboutQtAct;
     QAction *findAct;
+    QAction *searchAct;
+    QAction *duplicatesAct;
+    QAction *statisticsAct;
+    QAction *detailsAct;
+    QAction *hashAct;
+    QAction *crc32Act;
+    QAction *overlayAct;
+    QAction *cacheAct;
+    QAction *followAct;
+    QAction *carveAct;
+    QAction *diagnosticsAct;
 
     QSplitter *m_splitter;
+    QueryBox *m_querybox;
     QTreeView *m_treeview;
     QHexView *m_hexview;
+    HexOverlay *m_overlay;
+    QDockWidget *m_detailsDock;
+    ChunkDetails *m_details;
+    QProgressBar *m_progress;
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_followTimer;
+    SearchDialog *m_searchDialog{nullptr};
+    DuplicatesDialog *m_duplicatesDialog{nullptr};
+    StatisticsDialog *m_statisticsDialog{nullptr};
 
     TreeModel *m_treemodel{nullptr};
     QHexDocument *m_hexdoc{nullptr};
+    std::unique_ptr<QFile> m_file;
+    std::unique_ptr<FileWindows> m_windows;
+    uint8_t *m_buffer{nullptr};
+    qint64 m_mappedSize{0};
+    qint64 m_openStart{0};
+    bool m_openPending{false};
+    bool m_treePainted{true};
+    bool m_hexPainted{true};
+    bool m_selectingChunk{false};
 
+    QString m_filePath;
     QString m_openFileName;
     QString m_currentLang{"en_US"};
+    int m_expandDepth{3};
+    int m_expandBudget{10000};
+    int m_expandedRows{0};
+    bool m_useCache{true};
+    bool m_follow{false};
+    bool m_carve{false};
+    qint64 m_cacheLimit{256 * 1024 * 1024};
+    // all of the address space of 32-bit builds is not available for files;
+    // 64-bit builds map them whole unless that fails
+    qint64 m_mappingBudget{sizeof(void *) < 8 ? qint64(512) * 1024 * 1024 : 0};
+    FileMapping::Policy m_mappingPolicy{FileMapping::Default};
+    // the settings not saved on exit, set for this session only
+    QSet<QString> m_sessionOnly;
     QTranslator appTranslator;
     QTranslator qtTranslator;
 };
@@ -0,0 +1,227 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    patternsearch.cpp
+
+    Searches a memory mapped file for a byte pattern, in slices spread over
+    a thread pool, with 16 candidate positions tested at a time.
+*/
+
+#include <QRunnable>
+#include <QThread>
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PATTERNSEARCH_SSE2
+#endif
+
+#include "patternsearch.h"
+#include "profiler.h"
+
+namespace {
+// Bytes searched by one task: small enough to stop soon after a cancel and
+// to keep every thread busy until the end, big enough to make the cost of
+// queueing a task negligible.
+constexpr qint64 SliceSize{8 << 20};
+} // namespace
+
+constexpr int PatternSearch::MaxHits;
+
+class PatternSearch::Slice : public QRunnable
+{
+public:
+    Slice(PatternSearch *search, int generation, const uint8_t *buffer, qint64 from, qint64 to, qint64 end,
+          const QByteArray &pattern)
+        : m_search(search)
+        , m_generation(generation)
+        , m_buffer(buffer)
+        , m_from(from)
+        , m_to(to)
+        , m_end(end)
+        , m_pattern(pattern)
+    {}
+
+    void run() override
+    {
+        if (m_search->m_generation.load() != m_generation) {
+            return;
+        }
+        ProfileScope scope("search slice");
+        scope.setArg(0, "bytes", m_to - m_from);
+        // a match may start in this slice and end in the next one
+        const uint8_t *end = m_buffer + qMin(m_to + m_pattern.size() - 1, m_end);
+        QVector<qint64> offsets;
+        qint64 hits = 0;
+        for (const uint8_t *pos = m_buffer + m_from;; ++pos) {
+            pos = find(pos, end, m_pattern);
+            if (pos == end) {
+                break;
+            }
+            if (offsets.size() < MaxHits) {
+                offsets.append(pos - m_buffer);
+            }
+            ++hits;
+        }
+        scope.setArg(1, "hits", hits);
+        PatternSearch *search = m_search;
+        const int generation = m_generation;
+        const qint64 bytes = m_to - m_from;
+        QMetaObject::invokeMethod(
+            search,
+            [=] { search->sliceDone(generation, bytes, offsets, hits); },
+            Qt::QueuedConnection);
+    }
+
+private:
+    PatternSearch *m_search;
+    int m_generation;
+    const uint8_t *m_buffer;
+    qint64 m_from;
+    qint64 m_to; // one past the last offset where a match may start
+    qint64 m_end;
+    QByteArray m_pattern;
+};
+
+PatternSearch::PatternSearch(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<QVector<qint64>>();
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+PatternSearch::~PatternSearch()
+{
+    cancel();
+}
+
+QByteArray PatternSearch::parsePattern(Mode mode, const QString &text)
+{
+    switch (mode) {
+    case Mode::Hex: {
+        // fromHex() skips anything that is not a digit, which must not go unnoticed
+        QString digits = text;
+        const QByteArray hex = digits.remove(QLatin1Char(' ')).toLower().toLatin1();
+        const QByteArray bytes = QByteArray::fromHex(hex);
+        return bytes.toHex() == hex ? bytes : QByteArray{};
+    }
+    case Mode::Fourcc: {
+        // shorter ids are padded with spaces, as in "fmt "
+        const QByteArray id = text.toLatin1();
+        return id.isEmpty() || id.size() > 4 ? QByteArray{} : id.leftJustified(4, ' ');
+    }
+    default:
+        return text.toUtf8();
+    }
+}
+
+//
+// Positions where both the first and the last byte of the pattern match
+// are found 16 at a time with SSE2, and only those are compared in full:
+// the last byte rules out most of the candidates that the first one alone
+// would leave, so that the search runs close to memory bandwidth. Without
+// SSE2, memchr() provides the first byte candidates.
+//
+
+const uint8_t *PatternSearch::find(const uint8_t *begin, const uint8_t *end, const QByteArray &pattern)
+{
+    const qint64 length = pattern.size();
+    if (length == 0 || end - begin < length) {
+        return end;
+    }
+    const auto *bytes = reinterpret_cast<const uint8_t *>(pattern.constData());
+    // the last position where a match can start, plus one
+    const uint8_t *stop = end - length + 1;
+    const uint8_t *pos = begin;
+#ifdef PATTERNSEARCH_SSE2
+    const __m128i first = _mm_set1_epi8(char(bytes[0]));
+    const __m128i last = _mm_set1_epi8(char(bytes[length - 1]));
+    while (stop - pos >= 16) {
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos + length - 1));
+        uint32_t mask = uint32_t(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))));
+        while (mask != 0) {
+            const uint8_t *candidate = pos + qCountTrailingZeroBits(mask);
+            if (std::memcmp(candidate, bytes, size_t(length)) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+        pos += 16;
+    }
+#endif
+    while (pos < stop) {
+        pos = static_cast<const uint8_t *>(std::memchr(pos, bytes[0], size_t(stop - pos)));
+        if (pos == nullptr) {
+            break;
+        }
+        if (std::memcmp(pos, bytes, size_t(length)) == 0) {
+            return pos;
+        }
+        ++pos;
+    }
+    return end;
+}
+
+void PatternSearch::setBuffer(const uint8_t *buffer, qint64 length)
+{
+    cancel();
+    m_buffer = buffer;
+    m_length = length;
+}
+
+void PatternSearch::start(const QByteArray &pattern, qint64 from, qint64 to)
+{
+    cancel();
+    to = qMin(to, m_length);
+    m_done = 0;
+    m_hits = 0;
+    m_total = 0;
+    if (m_buffer == nullptr || pattern.isEmpty() || from < 0 || to - from < pattern.size()) {
+        emit finished(0);
+        return;
+    }
+    // the slices split the offsets where a match can start, each one
+    // reading up to the end of the matches starting in it
+    const qint64 last = to - pattern.size() + 1;
+    const int generation = m_generation.load();
+    m_total = last - from;
+    for (qint64 begin = from; begin < last; begin += SliceSize) {
+        m_pool.start(new Slice(this, generation, m_buffer, begin, qMin(begin + SliceSize, last), to, pattern));
+        ++m_pendingSlices;
+    }
+}
+
+void PatternSearch::cancel()
+{
+    // queued results of the slices still running are ignored
+    ++m_generation;
+    m_pool.clear();
+    m_pool.waitForDone();
+    m_pendingSlices = 0;
+}
+
+bool PatternSearch::isRunning() const
+{
+    return m_pendingSlices > 0;
+}
+
+void PatternSearch::sliceDone(int generation, qint64 bytes, const QVector<qint64> &offsets, qint64 hits)
+{
+    if (generation != m_generation.load() || m_pendingSlices == 0) {
+        return;
+    }
+    const qint64 room = qMax(MaxHits - qMin(m_hits, qint64(MaxHits)), qint64(0));
+    if (room > 0 && !offsets.isEmpty()) {
+        emit hitsFound(offsets.size() > room ? offsets.mid(0, int(room)) : offsets);
+    }
+    m_hits += hits;
+    m_done += bytes;
+    emit progress(m_done, m_total);
+    if (--m_pendingSlices == 0) {
+        emit finished(m_hits);
+    }
+}
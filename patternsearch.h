@@ -0,0 +1,68 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PATTERNSEARCH_H
+#define PATTERNSEARCH_H
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+
+Q_DECLARE_METATYPE(QVector<qint64>)
+
+//
+// Finds every occurrence of a byte pattern in a range of a memory mapped
+// file. The range is split in slices searched in parallel by a pool of its
+// own, and the offsets found are published in batches, in no particular
+// order, as the slices are done.
+//
+
+class PatternSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Mode { Text, Hex, Fourcc };
+
+    // the hits kept by one search; the rest are only counted
+    static constexpr int MaxHits{100000};
+
+    explicit PatternSearch(QObject *parent = nullptr);
+    ~PatternSearch() override;
+
+    // the text as typed in each mode, or an empty array when it is not valid
+    static QByteArray parsePattern(Mode mode, const QString &text);
+    // the first occurrence of the pattern in [begin, end), or end
+    static const uint8_t *find(const uint8_t *begin, const uint8_t *end, const QByteArray &pattern);
+
+    void setBuffer(const uint8_t *buffer, qint64 length);
+    void start(const QByteArray &pattern, qint64 from, qint64 to);
+    // stops the search, waiting for the slices being searched
+    void cancel();
+    bool isRunning() const;
+
+signals:
+    void hitsFound(const QVector<qint64> &offsets);
+    void progress(qint64 done, qint64 total);
+    void finished(qint64 hits);
+
+private:
+    class Slice;
+    void sliceDone(int generation, qint64 bytes, const QVector<qint64> &offsets, qint64 hits);
+
+    const uint8_t *m_buffer{nullptr};
+    qint64 m_length{0};
+    QThreadPool m_pool;
+    std::atomic<int> m_generation{0};
+    // counted on the GUI thread only
+    int m_pendingSlices{0};
+    qint64 m_done{0};
+    qint64 m_total{0};
+    qint64 m_hits{0};
+};
+
+#endif // PATTERNSEARCH_H
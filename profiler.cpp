@@ -0,0 +1,184 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    profiler.cpp
+
+    Storage, summary and Chrome trace export of the recorded phases.
+*/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <vector>
+
+#include "profiler.h"
+
+namespace {
+// Recording stops growing after this many events, a few tens of MiB,
+// so that leaving it enabled does not exhaust the memory.
+constexpr size_t MaxEvents{1000000};
+
+QMutex s_mutex;
+QElapsedTimer s_clock;
+std::vector<TraceEvent> s_events;
+QHash<quintptr, QString> s_threadNames;
+
+void appendEvent(const TraceEvent &event)
+{
+    QMutexLocker locker(&s_mutex);
+    if (s_events.size() >= MaxEvents) {
+        return;
+    }
+    if (!s_threadNames.contains(event.thread)) {
+        QThread *thread = QThread::currentThread();
+        const bool isMain = QCoreApplication::instance() != nullptr
+                            && thread == QCoreApplication::instance()->thread();
+        s_threadNames.insert(event.thread,
+                             isMain ? QStringLiteral("GUI")
+                                    : thread->objectName().isEmpty() ? QStringLiteral("worker")
+                                                                     : thread->objectName());
+    }
+    s_events.push_back(event);
+}
+} // namespace
+
+std::atomic<bool> Profiler::s_enabled{false};
+
+void Profiler::setEnabled(bool enabled)
+{
+    QMutexLocker locker(&s_mutex);
+    if (enabled && !s_clock.isValid()) {
+        s_clock.start();
+    }
+    s_enabled.store(enabled);
+}
+
+void Profiler::clear()
+{
+    QMutexLocker locker(&s_mutex);
+    s_events.clear();
+    s_events.shrink_to_fit();
+    s_threadNames.clear();
+}
+
+qint64 Profiler::now()
+{
+    return s_clock.nsecsElapsed();
+}
+
+void Profiler::addSpan(const char *name, qint64 start, const char *const argNames[2], const qint64 argValues[2])
+{
+    appendEvent(TraceEvent{name,
+                           'X',
+                           start,
+                           now() - start,
+                           quintptr(QThread::currentThreadId()),
+                           {argNames[0], argNames[1]},
+                           {argValues[0], argValues[1]}});
+}
+
+void Profiler::addCounter(const char *name, qint64 value)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    appendEvent(TraceEvent{name, 'C', now(), 0, quintptr(QThread::currentThreadId()), {name, nullptr}, {value, 0}});
+}
+
+QVector<PhaseSummary> Profiler::phases()
+{
+    QMutexLocker locker(&s_mutex);
+    QVector<PhaseSummary> result;
+    QHash<QString, int> rows;
+    for (const TraceEvent &event : s_events) {
+        if (event.phase != 'X') {
+            continue;
+        }
+        const QString name = QString::fromLatin1(event.name);
+        auto row = rows.find(name);
+        if (row == rows.end()) {
+            row = rows.insert(name, result.size());
+            result.append(PhaseSummary{name, 0, 0, 0});
+        }
+        PhaseSummary &phase = result[row.value()];
+        ++phase.count;
+        phase.total += event.duration;
+        phase.longest = qMax(phase.longest, event.duration);
+    }
+    return result;
+}
+
+QVector<QPair<QString, qint64>> Profiler::counters()
+{
+    QMutexLocker locker(&s_mutex);
+    // the latest value of every counter, by name
+    QMap<QString, qint64> latest;
+    for (const TraceEvent &event : s_events) {
+        if (event.phase == 'C') {
+            latest.insert(QString::fromLatin1(event.name), event.argValues[0]);
+        }
+    }
+    QVector<QPair<QString, qint64>> result;
+    for (auto it = latest.cbegin(); it != latest.cend(); ++it) {
+        result.append(qMakePair(it.key(), it.value()));
+    }
+    return result;
+}
+
+bool Profiler::exportTrace(const QString &fileName)
+{
+    QMutexLocker locker(&s_mutex);
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+    for (auto it = s_threadNames.cbegin(); it != s_threadNames.cend(); ++it) {
+        QJsonObject metadata;
+        metadata["name"] = "thread_name";
+        metadata["ph"] = "M";
+        metadata["pid"] = pid;
+        metadata["tid"] = qint64(it.key());
+        metadata["args"] = QJsonObject{{"name", it.value()}};
+        events.append(metadata);
+    }
+    // timestamps and durations are microseconds in this format
+    for (const TraceEvent &event : s_events) {
+        QJsonObject object;
+        object["name"] = event.name;
+        object["cat"] = event.phase == 'C' ? "counter" : "phase";
+        object["ph"] = QString(QChar(event.phase));
+        object["ts"] = double(event.start) / 1000.0;
+        if (event.phase == 'X') {
+            object["dur"] = double(event.duration) / 1000.0;
+        }
+        object["pid"] = pid;
+        object["tid"] = qint64(event.thread);
+        QJsonObject args;
+        for (int i = 0; i < 2; ++i) {
+            if (event.argNames[i] != nullptr) {
+                args[event.argNames[i]] = event.argValues[i];
+            }
+        }
+        if (!args.isEmpty()) {
+            object["args"] = args;
+        }
+        events.append(object);
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
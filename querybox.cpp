@@ -0,0 +1,137 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QElapsedTimer>
+#include <QLocale>
+#include <QVBoxLayout>
+#include <algorithm>
+
+#include "chunkquery.h"
+#include "profiler.h"
+#include "querybox.h"
+#include "riffscanner.h"
+#include "treemodel.h"
+
+namespace {
+enum Column { PathColumn, OffsetColumn, SizeColumn };
+enum Role { OffsetRole = Qt::UserRole, LengthRole };
+} // namespace
+
+QueryBox::QueryBox(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->setContentsMargins(0, 0, 0, 0);
+    m_queryEdit = new QLineEdit(this);
+    m_queryEdit->setPlaceholderText(tr("Path query, like LIST(INFO)/* or //strh"));
+    m_queryEdit->setClearButtonEnabled(true);
+    m_queryEdit->setToolTip(tr("Steps separated by '/' for children and '//' for descendants.\n"
+                               "A step is a chunk id, a list as id(type), or '*' for any of them.\n"
+                               "Paths not starting with '/' are found at any depth.\n"
+                               "Press Enter to run the query."));
+    mainLayout->addWidget(m_queryEdit);
+
+    m_results = new QTreeWidget(this);
+    m_results->setRootIsDecorated(false);
+    m_results->setUniformRowHeights(true);
+    m_results->setHeaderLabels({tr("Path"), tr("Offset"), tr("Size")});
+    m_results->setVisible(false);
+    mainLayout->addWidget(m_results, 1);
+    m_status = new QLabel(this);
+    m_status->setVisible(false);
+    mainLayout->addWidget(m_status);
+
+    connect(m_queryEdit, &QLineEdit::returnPressed, this, &QueryBox::runQuery);
+    connect(m_queryEdit, &QLineEdit::textChanged, this, &QueryBox::queryEdited);
+    connect(m_results, &QTreeWidget::itemActivated, this, &QueryBox::activateItem);
+    connect(m_results, &QTreeWidget::itemClicked, this, &QueryBox::activateItem);
+}
+
+void QueryBox::setModel(TreeModel *model)
+{
+    m_model = model;
+    clearResults();
+    if (!m_queryEdit->text().trimmed().isEmpty()) {
+        runQuery();
+    }
+}
+
+void QueryBox::clearResults()
+{
+    m_results->clear();
+    m_results->setVisible(false);
+    m_status->clear();
+    m_status->setVisible(false);
+}
+
+void QueryBox::queryEdited(const QString &text)
+{
+    if (text.trimmed().isEmpty()) {
+        clearResults();
+    }
+}
+
+void QueryBox::runQuery()
+{
+    clearResults();
+    if (m_model == nullptr || m_queryEdit->text().trimmed().isEmpty()) {
+        return;
+    }
+    m_status->setVisible(true);
+    ChunkQuery query;
+    QString error;
+    if (!ChunkQuery::parse(m_queryEdit->text(), query, error)) {
+        m_status->setText(tr("Invalid query: %1").arg(error));
+        return;
+    }
+
+    ProfileScope scope("chunk query");
+    QElapsedTimer timer;
+    timer.start();
+    const ChunkTable &table = m_model->chunks();
+    const std::vector<int32_t> nodes = query.run(table, m_model->chunkIndex());
+    scope.setArg(0, "matches", qint64(nodes.size()));
+
+    const QLocale locale;
+    const size_t shown = std::min(nodes.size(), size_t(ChunkQuery::MaxResults));
+    ChunkLabels labels;
+    QList<QTreeWidgetItem *> items;
+    items.reserve(int(shown));
+    for (size_t i = 0; i < shown; ++i) {
+        const ChunkNode &node = table.node(nodes[i]);
+        auto *item = new QTreeWidgetItem;
+        item->setText(PathColumn, ChunkQuery::path(table, nodes[i], labels));
+        item->setText(OffsetColumn, QString::number(node.offset));
+        item->setText(SizeColumn, QString::number(node.size));
+        item->setTextAlignment(OffsetColumn, Qt::AlignRight);
+        item->setTextAlignment(SizeColumn, Qt::AlignRight);
+        item->setData(PathColumn, OffsetRole, qint64(node.offset));
+        item->setData(PathColumn, LengthRole, RiffScanner::HeaderSize + qint64(node.size));
+        items.append(item);
+    }
+    m_results->addTopLevelItems(items);
+    m_results->resizeColumnToContents(PathColumn);
+    m_results->setVisible(!items.isEmpty());
+
+    // the lists not expanded yet have no children in the table
+    const QString scanned = tr("among the %1 scanned").arg(locale.toString(m_model->chunkCount()));
+    if (nodes.size() > shown) {
+        m_status->setText(tr("%1 of %2 chunks in %3 ms, %4")
+                              .arg(locale.toString(qint64(shown)), locale.toString(qint64(nodes.size())))
+                              .arg(timer.elapsed())
+                              .arg(scanned));
+    } else {
+        m_status->setText(tr("%1 chunks in %2 ms, %3")
+                              .arg(locale.toString(qint64(nodes.size())))
+                              .arg(timer.elapsed())
+                              .arg(scanned));
+    }
+}
+
+void QueryBox::activateItem(QTreeWidgetItem *item)
+{
+    if (item != nullptr) {
+        emit chunkActivated(item->data(PathColumn, OffsetRole).toLongLong(),
+                            item->data(PathColumn, LengthRole).toLongLong());
+    }
+}
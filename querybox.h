@@ -0,0 +1,46 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef QUERYBOX_H
+#define QUERYBOX_H
+
+#include <QLabel>
+#include <QLineEdit>
+#include <QTreeWidget>
+#include <QWidget>
+
+class TreeModel;
+
+//
+// A path query over the chunks of the tree, shown above it. The matches
+// are listed apart instead of hiding the rows of the tree, which would
+// take as long as the tree is wide, and only the lists scanned so far are
+// searched, through the index the model keeps while they are inserted.
+//
+
+class QueryBox : public QWidget {
+    Q_OBJECT
+public:
+    explicit QueryBox(QWidget *parent = nullptr);
+
+    // the model queried; the previous results are dropped
+    void setModel(TreeModel *model);
+
+signals:
+    void chunkActivated(qint64 offset, qint64 length);
+
+private slots:
+    void runQuery();
+    void queryEdited(const QString &text);
+    void activateItem(QTreeWidgetItem *item);
+
+private:
+    void clearResults();
+
+    TreeModel *m_model{nullptr};
+    QLineEdit *m_queryEdit;
+    QTreeWidget *m_results;
+    QLabel *m_status;
+};
+
+#endif // QUERYBOX_H
@@ -33,23 +33,104 @@
 namespace riff
 {
 
-template <typename D>
+template <typename D, typename Order>
 struct RiffList;
 
+//
+// Byte orders of the size fields
+//
+// The bytes are assembled one by one, which compilers turn into a single
+// load, byte swapped when needed, with no alignment requirement.
+//
+
+struct LittleEndian
+{
+    static uint16_t read16(const void *pointer)
+    {
+        const auto *b = static_cast<const uint8_t *>(pointer);
+        return uint16_t(b[0] | b[1] << 8);
+    }
+
+    static uint32_t read32(const void *pointer)
+    {
+        const auto *b = static_cast<const uint8_t *>(pointer);
+        return uint32_t(b[0]) | uint32_t(b[1]) << 8 | uint32_t(b[2]) << 16 | uint32_t(b[3]) << 24;
+    }
+
+    static uint64_t read64(const void *pointer)
+    {
+        const auto *b = static_cast<const uint8_t *>(pointer);
+        return uint64_t(read32(b)) | uint64_t(read32(b + 4)) << 32;
+    }
+};
+
+struct BigEndian
+{
+    static uint16_t read16(const void *pointer)
+    {
+        const auto *b = static_cast<const uint8_t *>(pointer);
+        return uint16_t(b[0] << 8 | b[1]);
+    }
+
+    static uint32_t read32(const void *pointer)
+    {
+        const auto *b = static_cast<const uint8_t *>(pointer);
+        return uint32_t(b[0]) << 24 | uint32_t(b[1]) << 16 | uint32_t(b[2]) << 8 | uint32_t(b[3]);
+    }
+
+    static uint64_t read64(const void *pointer)
+    {
+        const auto *b = static_cast<const uint8_t *>(pointer);
+        return uint64_t(read32(b)) << 32 | uint64_t(read32(b + 4));
+    }
+};
+
+//
+// Conversion of four character codes stored as raw integers
+//
+// Four character codes are bytes in file order in every container, so
+// they are always read as little endian integers, the same as the TYPE_
+// constants below.
+//
+
+// the value of a literal id, usable as a template argument: makeFourcc("fmt ")
+constexpr uint32_t makeFourcc(const char (&id)[5])
+{
+    return uint32_t(uint8_t(id[0])) | uint32_t(uint8_t(id[1])) << 8 | uint32_t(uint8_t(id[2])) << 16
+           | uint32_t(uint8_t(id[3])) << 24;
+}
+
+inline uint32_t readFourcc(const void *pointer)
+{
+    return LittleEndian::read32(pointer);
+}
+
+inline std::string fourccToStdString(uint32_t fourcc)
+{
+    return std::string(reinterpret_cast<const char *>(&fourcc), sizeof(fourcc));
+}
+
+#if defined(QT_CORE_LIB)
+inline QString fourccToQString(uint32_t fourcc)
+{
+    return QString::fromLatin1(reinterpret_cast<const char *>(&fourcc), sizeof(fourcc));
+}
+#endif
+
 //
 // Class RiffChunk
 //
 // Template which instantiate to a class of RIFF chunk according
-// to the type of data stored.
+// to the type of data stored, and the byte order of the size field.
 //
 
 constexpr int alignsize{sizeof(uint32_t)};
 
 #pragma pack(push, alignsize)
-template<typename D = uint8_t>
+template<typename D = uint8_t, typename Order = LittleEndian>
 struct RiffChunk
 {
-    typedef RiffChunk<D> Type;
+    typedef RiffChunk<D, Order> Type;
 
     //
     // Chunk fields
@@ -66,6 +147,19 @@ struct RiffChunk
     static constexpr uint32_t TYPE_RIFF = 0x46464952;
     static constexpr uint32_t TYPE_LIST = 0x5453494C;
     static constexpr uint32_t TYPE_INFO = 0x4F464E49;
+    static constexpr uint32_t TYPE_RF64 = 0x34364652;
+    static constexpr uint32_t TYPE_BW64 = 0x34365742;
+    static constexpr uint32_t TYPE_DS64 = 0x34367364;
+    static constexpr uint32_t TYPE_DATA = 0x61746164;
+    static constexpr uint32_t TYPE_RIFX = 0x58464952;
+    static constexpr uint32_t TYPE_FORM = 0x4D524F46;
+    static constexpr uint32_t TYPE_CAT = 0x20544143;
+    static constexpr uint32_t TYPE_PROP = 0x504F5250;
+
+    uint32_t chunkSize() const
+    {
+        return Order::read32(&size);
+    }
 
     bool hasTypeRiff() const
     {
@@ -77,6 +171,12 @@ struct RiffChunk
         return type == TYPE_LIST;
     }
 
+    // RIFF files larger than 4 GiB, with their sizes in a ds64 chunk
+    bool hasTypeRf64() const
+    {
+        return type == TYPE_RF64 || type == TYPE_BW64;
+    }
+
     std::string typeToStdString() const
     {
         return std::string(
@@ -95,33 +195,33 @@ struct RiffChunk
     // Get a pointer to the end of data section
     //
 
-    void *dataEnd() { return reinterpret_cast<uint8_t *>(data) + size; }
+    void *dataEnd() { return reinterpret_cast<uint8_t *>(data) + chunkSize(); }
 
     //
     // Get the offset to the beginning of the structure
     //
 
-    const uintptr_t offset(uint8_t *baseptr) const
+    uintptr_t offset(const uint8_t *baseptr) const
     {
         return reinterpret_cast<const uint8_t *>(&type) - baseptr;
     }
 
-    const void *dataEnd() const { return reinterpret_cast<const uint8_t *>(data) + size; }
+    const void *dataEnd() const { return reinterpret_cast<const uint8_t *>(data) + chunkSize(); }
 
     //
     // Get a pointer to the next chunk (16-bit aligned)
     //
 
     template <typename C = uint8_t>
-    RiffChunk<C>* nextChunk()
+    RiffChunk<C, Order>* nextChunk()
     {
-        return reinterpret_cast<RiffChunk<C> *>(alignPointer(dataEnd(), sizeof(int16_t)));
+        return reinterpret_cast<RiffChunk<C, Order> *>(alignPointer(dataEnd(), sizeof(int16_t)));
     }
 
     template <typename C = uint8_t>
-    const RiffChunk<C>* nextChunk() const
+    const RiffChunk<C, Order>* nextChunk() const
     {
-        return reinterpret_cast<const RiffChunk<C> *>(alignPointer(dataEnd(), sizeof(int16_t)));
+        return reinterpret_cast<const RiffChunk<C, Order> *>(alignPointer(dataEnd(), sizeof(int16_t)));
     }
 
     //
@@ -129,15 +229,15 @@ struct RiffChunk
     //
 
     template <typename C>
-    RiffChunk<C>* castTo()
+    RiffChunk<C, Order>* castTo()
     {
-        return reinterpret_cast<RiffChunk<C>*>(this);
+        return reinterpret_cast<RiffChunk<C, Order>*>(this);
     }
 
     template <typename C>
-    const RiffChunk<C>* castTo() const
+    const RiffChunk<C, Order>* castTo() const
     {
-        return reinterpret_cast<const RiffChunk<C>*>(this);
+        return reinterpret_cast<const RiffChunk<C, Order>*>(this);
     }
 
 private:
@@ -158,14 +258,14 @@ private:
 // Data type of data section in chunks of type RIFF list
 //
 
-template<typename D = uint8_t>
+template<typename D = uint8_t, typename Order = LittleEndian>
 struct RiffList
 {
-    typedef RiffList<D> Type;
-    typedef RiffChunk<RiffList<D> > Chunk;
+    typedef RiffList<D, Order> Type;
+    typedef RiffChunk<RiffList<D, Order>, Order> Chunk;
 
     uint32_t listType;
-    RiffChunk<D> chunks[1];
+    RiffChunk<D, Order> chunks[1];
 
     std::string listTypeToStdString() const
     {
@@ -181,12 +281,83 @@ struct RiffList
 #endif
 
 private:
-    RiffList()
-        : RiffList<D>()
-    {}
+    RiffList() = delete;
 };
 #pragma pack(pop)
 
+//
+// Container formats
+//
+// The byte order of the sizes, the chunk ids starting a file, and those of
+// the lists, which have a type after the size followed by nested chunks.
+// Chunks are 16-bit aligned in all of them.
+//
+
+struct RiffFormat
+{
+    typedef LittleEndian Order;
+
+    // files larger than 4 GiB, with the 64-bit sizes in a ds64 chunk
+    static bool hasDs64(uint32_t container)
+    {
+        return container == RiffChunk<>::TYPE_RF64 || container == RiffChunk<>::TYPE_BW64;
+    }
+
+    static bool isContainer(uint32_t fourcc)
+    {
+        return fourcc == RiffChunk<>::TYPE_RIFF || fourcc == RiffChunk<>::TYPE_RF64
+               || fourcc == RiffChunk<>::TYPE_BW64;
+    }
+
+    static bool isList(uint32_t fourcc)
+    {
+        return fourcc == RiffChunk<>::TYPE_LIST || isContainer(fourcc);
+    }
+};
+
+// RIFF with big endian sizes, as written by Macromedia Director and others
+struct RifxFormat
+{
+    typedef BigEndian Order;
+
+    static bool hasDs64(uint32_t)
+    {
+        return false;
+    }
+
+    static bool isContainer(uint32_t fourcc)
+    {
+        return fourcc == RiffChunk<>::TYPE_RIFX;
+    }
+
+    static bool isList(uint32_t fourcc)
+    {
+        return fourcc == RiffChunk<>::TYPE_LIST || isContainer(fourcc);
+    }
+};
+
+// EA IFF 85 and its descendants, like AIFF, AIFC, 8SVX or ILBM
+struct IffFormat
+{
+    typedef BigEndian Order;
+
+    static bool hasDs64(uint32_t)
+    {
+        return false;
+    }
+
+    static bool isContainer(uint32_t fourcc)
+    {
+        return fourcc == RiffChunk<>::TYPE_FORM || fourcc == RiffChunk<>::TYPE_LIST
+               || fourcc == RiffChunk<>::TYPE_CAT;
+    }
+
+    static bool isList(uint32_t fourcc)
+    {
+        return fourcc == RiffChunk<>::TYPE_PROP || isContainer(fourcc);
+    }
+};
+
 } // namespace riff
 
 #endif // RIFF_H
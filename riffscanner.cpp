@@ -0,0 +1,727 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+/*
+    riffscanner.cpp
+
+    Scans the children of one list chunk of a memory mapped RIFF, RIFX or
+    IFF file, mapped whole or a window at a time, on a worker thread,
+    publishing the chunks found in batches to the GUI thread. Nested lists
+    are not entered: they are scanned on demand.
+*/
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
+#include <vector>
+
+#include "patternsearch.h"
+#include "profiler.h"
+#include "riffscanner.h"
+
+namespace {
+// Batches are flushed when they reach this size or after this many
+// milliseconds, whichever comes first, so the first chunks show up
+// right away without flooding the event loop on huge lists.
+constexpr int MaxBatchSize{8192};
+constexpr qint64 MaxBatchInterval{50};
+
+// Smaller files are always scanned on the calling thread, and lists
+// smaller than this are never split further.
+constexpr qint64 MinParallelSize{1 << 20};
+constexpr qint64 MinSubtreeSize{64 << 10};
+
+// The whole tree scans check their cancel flag every list and every this
+// many chunks, and carving every block; the scans without a flag get this
+// one, never set.
+constexpr int CancelBatchSize{4096};
+const std::atomic<bool> NeverCancelled{false};
+
+// Carving looks for the container ids in slices of the file, each one read
+// a block at a time so that the search of every id finds it in the cache,
+// and checks the first children of each candidate.
+constexpr qint64 CarveSliceSize{4 << 20};
+constexpr qint64 CarveBlockSize{256 << 10};
+constexpr int CarveProbeCount{8};
+
+// The ds64 chunk of RF64 and BW64 files follows their header, with the
+// 64-bit sizes of the RIFF and data chunks, the sample count, and the
+// length of a table of {fourcc, size} pairs for any other big chunk.
+constexpr qint64 Ds64Offset{12};
+constexpr qint64 Ds64Fields{Ds64Offset + 2 * sizeof(uint32_t)};
+constexpr qint64 Ds64TableOffset{Ds64Fields + 3 * sizeof(uint64_t) + sizeof(uint32_t)};
+constexpr qint64 Ds64EntrySize{sizeof(uint32_t) + sizeof(uint64_t)};
+} // namespace
+
+constexpr qint64 RiffScanner::HeaderSize;
+constexpr quint32 RiffScanner::PlaceholderSize;
+constexpr quint64 RiffScanner::MaxSize;
+
+RiffScanner::RiffScanner(const uint8_t *buffer, qint64 length, QObject *parent)
+    : QObject(parent)
+    , m_buffer(buffer)
+    , m_length(length)
+    , m_format(format(buffer, length))
+{}
+
+RiffScanner::RiffScanner(FileWindows *windows, qint64 length, QObject *parent)
+    : QObject(parent)
+    , m_buffer(nullptr)
+    , m_reader(new FileWindows::Reader(windows))
+    , m_length(length)
+    , m_format(format(m_reader.get(), length))
+{}
+
+int RiffScanner::generation() const
+{
+    return m_generation.load();
+}
+
+void RiffScanner::cancel()
+{
+    // pending and running requests belong to the previous generation and stop
+    m_generation.fetch_add(1);
+}
+
+RiffScanner::Format RiffScanner::format(const uint8_t *buffer, qint64 length)
+{
+    if (length < HeaderSize + qint64(sizeof(uint32_t))) {
+        return Format::Unknown;
+    }
+    const quint32 fourcc = riff::readFourcc(buffer);
+    if (riff::RiffFormat::isContainer(fourcc)) {
+        return Format::Riff;
+    }
+    if (riff::RifxFormat::isContainer(fourcc)) {
+        return Format::Rifx;
+    }
+    if (riff::IffFormat::isContainer(fourcc)) {
+        return Format::Iff;
+    }
+    return Format::Unknown;
+}
+
+RiffScanner::Format RiffScanner::format(FileWindows::Reader *reader, qint64 length)
+{
+    if (length < HeaderSize + qint64(sizeof(uint32_t))) {
+        return Format::Unknown;
+    }
+    return format(reader->at(0, sizeof(uint32_t)), length);
+}
+
+bool RiffScanner::isRiff(const uint8_t *buffer, qint64 length)
+{
+    return format(buffer, length) != Format::Unknown;
+}
+
+ChunkRecord RiffScanner::readChunk(Format format, const uint8_t *buffer, qint64 offset, qint64 end)
+{
+    return dispatch(format, [&](auto container) {
+        return readChunk<decltype(container)>(buffer, offset, end);
+    });
+}
+
+ChunkRecord RiffScanner::readChunk(Format format, FileWindows::Reader *reader, qint64 offset, qint64 end)
+{
+    return dispatch(format, [&](auto container) {
+        return readChunk<decltype(container)>(reader, offset, end);
+    });
+}
+
+template<typename Container, typename Bytes>
+ChunkRecord RiffScanner::readChunk(Bytes buffer, qint64 offset, qint64 end)
+{
+    const quint64 size = declaredSize<Container>(buffer, offset, end);
+    ChunkRecord record{riff::readFourcc(bytesAt(buffer, offset, sizeof(uint32_t))), 0, offset, size, 0, false};
+    if (Container::isList(record.fourcc)) {
+        record.listType = riff::readFourcc(bytesAt(buffer, offset + HeaderSize, sizeof(uint32_t)));
+        record.isList = true;
+    }
+    record.size = effectiveSize<Container>(buffer, record, end);
+    if (record.size != size) {
+        record.flags |= ChunkNode::Placeholder;
+    }
+    // nothing is ever read beyond the end of the parent
+    const qint64 available = qMax(end - offset - HeaderSize, qint64(0));
+    if (record.size > quint64(available)) {
+        record.size = quint64(available);
+        record.flags |= ChunkNode::Overrun;
+    }
+    return record;
+}
+
+template<typename Container, typename Bytes>
+quint64 RiffScanner::declaredSize(Bytes buffer, qint64 offset, qint64 end)
+{
+    using Order = typename Container::Order;
+    const quint32 size = Order::read32(bytesAt(buffer, offset + sizeof(uint32_t), sizeof(uint32_t)));
+    if (size != PlaceholderSize || !Container::hasDs64(riff::readFourcc(bytesAt(buffer, 0, sizeof(uint32_t))))) {
+        return size;
+    }
+    // The ds64 chunk is only trusted when it is complete before the chunk
+    // whose size is looked up, or inside the mapping for the RF64 chunk.
+    const qint64 limit = offset == 0 ? end : offset;
+    if (Ds64TableOffset > limit
+        || riff::readFourcc(bytesAt(buffer, Ds64Offset, sizeof(uint32_t))) != riff::RiffChunk<>::TYPE_DS64) {
+        return size;
+    }
+    quint64 resolved = size;
+    const quint32 fourcc = riff::readFourcc(bytesAt(buffer, offset, sizeof(uint32_t)));
+    if (offset == 0) {
+        resolved = Order::read64(bytesAt(buffer, Ds64Fields, sizeof(uint64_t)));
+    } else if (fourcc == riff::RiffChunk<>::TYPE_DATA) {
+        resolved = Order::read64(bytesAt(buffer, Ds64Fields + sizeof(uint64_t), sizeof(uint64_t)));
+    } else {
+        const qint64 ds64End = Ds64Fields
+                               + qint64(Order::read32(bytesAt(buffer, Ds64Offset + sizeof(uint32_t), sizeof(uint32_t))));
+        const qint64 tableEnd = qMin(limit, ds64End);
+        const quint32 count = Order::read32(bytesAt(buffer, Ds64Fields + 3 * sizeof(uint64_t), sizeof(uint32_t)));
+        qint64 pos = Ds64TableOffset;
+        for (quint32 i = 0; i < count && pos + Ds64EntrySize <= tableEnd; ++i, pos += Ds64EntrySize) {
+            const uint8_t *entry = bytesAt(buffer, pos, Ds64EntrySize);
+            if (riff::readFourcc(entry) == fourcc) {
+                resolved = Order::read64(entry + sizeof(uint32_t));
+                break;
+            }
+        }
+    }
+    return resolved <= MaxSize ? resolved : size;
+}
+
+bool RiffScanner::isPrintable(quint32 fourcc)
+{
+    // every byte between 0x20 and 0x7e, tested on the four bytes at once:
+    // the first term has the high bit of the bytes below 0x20, the second
+    // one the high bit of the bytes above 0x7e
+    constexpr quint32 Ones{0x01010101};
+    constexpr quint32 HighBits{0x80808080};
+    const quint32 below = (fourcc - Ones * 0x20) & ~fourcc & HighBits;
+    const quint32 above = ((fourcc + Ones * (0x7f - 0x7e)) | fourcc) & HighBits;
+    return (below | above) == 0;
+}
+
+template<typename Bytes>
+bool RiffScanner::isPlausibleHeader(Bytes buffer, qint64 pos, qint64 end)
+{
+    return pos + HeaderSize <= end && isPrintable(riff::readFourcc(bytesAt(buffer, pos, sizeof(uint32_t))));
+}
+
+template<typename Container, typename Bytes>
+bool RiffScanner::isValidChunk(Bytes buffer, qint64 pos, qint64 end)
+{
+    // a header that fits in its parent and is followed by another one,
+    // or by the end of the parent
+    if (pos + HeaderSize > end) {
+        return false;
+    }
+    const quint64 size = declaredSize<Container>(buffer, pos, end);
+    if (size > quint64(end - pos)) {
+        return false;
+    }
+    const qint64 next = pos + HeaderSize + qint64(size + (size & 1));
+    return next <= end + 1 && (next + HeaderSize > end || isPlausibleHeader(buffer, next, end));
+}
+
+template<typename Container, typename Bytes>
+qint64 RiffScanner::resync(Bytes buffer, qint64 from, qint64 end)
+{
+    for (qint64 pos = from; pos + HeaderSize <= end; ++pos) {
+        if (isPlausibleHeader(buffer, pos, end) && isValidChunk<Container>(buffer, pos, end)) {
+            return pos;
+        }
+    }
+    return end;
+}
+
+template<typename Container, typename Bytes>
+quint64 RiffScanner::effectiveSize(Bytes buffer, const ChunkRecord &chunk, qint64 end)
+{
+    // Recorders write placeholder sizes (zero or all ones) and fix them when
+    // they finish, and some update them only from time to time. Such chunks
+    // extend up to the end of their parent.
+    const qint64 dataOffset = chunk.offset + HeaderSize;
+    const quint64 available = quint64(qMax(end - dataOffset, qint64(0)));
+    if (chunk.size == PlaceholderSize) {
+        return available;
+    }
+    if (chunk.isList) {
+        // Padding or a tag may follow a list, so what is after its end is
+        // not enough: the size is stale only when a valid child crosses it.
+        const qint64 declaredEnd = dataOffset + qint64(chunk.size + (chunk.size & 1));
+        if (chunk.size < sizeof(uint32_t)
+            || (declaredEnd + HeaderSize <= end && !isPlausibleHeader(buffer, declaredEnd, end)
+                && hasChildAcross<Container>(buffer, chunk, declaredEnd, end))) {
+            return available;
+        }
+    } else if (chunk.size == 0 && dataOffset + HeaderSize <= end
+               && !isPlausibleHeader(buffer, dataOffset, end)) {
+        return available;
+    }
+    return chunk.size;
+}
+
+// whether the chain of children of the list, from its first one, has a
+// valid chunk that starts before the declared end and ends after it
+template<typename Container, typename Bytes>
+bool RiffScanner::hasChildAcross(Bytes buffer, const ChunkRecord &list, qint64 declaredEnd, qint64 end)
+{
+    qint64 pos = list.offset + HeaderSize + qint64(sizeof(uint32_t));
+    while (pos < declaredEnd) {
+        if (pos + HeaderSize > end || !isPrintable(riff::readFourcc(bytesAt(buffer, pos, sizeof(uint32_t))))) {
+            return false;
+        }
+        const quint64 size = declaredSize<Container>(buffer, pos, end);
+        if (size > quint64(end - pos)) {
+            return false;
+        }
+        const qint64 next = pos + HeaderSize + qint64(size + (size & 1));
+        if (next > declaredEnd) {
+            return isValidChunk<Container>(buffer, pos, end);
+        }
+        pos = next;
+    }
+    return false;
+}
+
+// used by scanChildren(), which is instantiated by its callers, for both kinds of Bytes
+template ChunkRecord RiffScanner::readChunk<riff::RiffFormat>(const uint8_t *, qint64, qint64);
+template quint64 RiffScanner::declaredSize<riff::RiffFormat>(const uint8_t *, qint64, qint64);
+template bool RiffScanner::isValidChunk<riff::RiffFormat>(const uint8_t *, qint64, qint64);
+template qint64 RiffScanner::resync<riff::RiffFormat>(const uint8_t *, qint64, qint64);
+template ChunkRecord RiffScanner::readChunk<riff::RifxFormat>(const uint8_t *, qint64, qint64);
+template quint64 RiffScanner::declaredSize<riff::RifxFormat>(const uint8_t *, qint64, qint64);
+template bool RiffScanner::isValidChunk<riff::RifxFormat>(const uint8_t *, qint64, qint64);
+template qint64 RiffScanner::resync<riff::RifxFormat>(const uint8_t *, qint64, qint64);
+template ChunkRecord RiffScanner::readChunk<riff::IffFormat>(const uint8_t *, qint64, qint64);
+template quint64 RiffScanner::declaredSize<riff::IffFormat>(const uint8_t *, qint64, qint64);
+template bool RiffScanner::isValidChunk<riff::IffFormat>(const uint8_t *, qint64, qint64);
+template qint64 RiffScanner::resync<riff::IffFormat>(const uint8_t *, qint64, qint64);
+template ChunkRecord RiffScanner::readChunk<riff::RiffFormat>(FileWindows::Reader *, qint64, qint64);
+template quint64 RiffScanner::declaredSize<riff::RiffFormat>(FileWindows::Reader *, qint64, qint64);
+template bool RiffScanner::isValidChunk<riff::RiffFormat>(FileWindows::Reader *, qint64, qint64);
+template qint64 RiffScanner::resync<riff::RiffFormat>(FileWindows::Reader *, qint64, qint64);
+template ChunkRecord RiffScanner::readChunk<riff::RifxFormat>(FileWindows::Reader *, qint64, qint64);
+template quint64 RiffScanner::declaredSize<riff::RifxFormat>(FileWindows::Reader *, qint64, qint64);
+template bool RiffScanner::isValidChunk<riff::RifxFormat>(FileWindows::Reader *, qint64, qint64);
+template qint64 RiffScanner::resync<riff::RifxFormat>(FileWindows::Reader *, qint64, qint64);
+template ChunkRecord RiffScanner::readChunk<riff::IffFormat>(FileWindows::Reader *, qint64, qint64);
+template quint64 RiffScanner::declaredSize<riff::IffFormat>(FileWindows::Reader *, qint64, qint64);
+template bool RiffScanner::isValidChunk<riff::IffFormat>(FileWindows::Reader *, qint64, qint64);
+template qint64 RiffScanner::resync<riff::IffFormat>(FileWindows::Reader *, qint64, qint64);
+
+int32_t RiffScanner::appendRecord(ChunkTable &table, int32_t parent, const ChunkRecord &chunk, qint64 length)
+{
+    if (chunk.isList) {
+        // the list type is the first field of the data section, and
+        // the children never go beyond the end of the parent
+        const qint64 dataOffset = chunk.offset + HeaderSize;
+        const qint64 parentEnd = parent == ChunkTable::Root ? length
+                                                            : qint64(table.listNode(parent).childrenEnd);
+        return table.appendList(parent,
+                                chunk.fourcc,
+                                chunk.listType,
+                                chunk.offset,
+                                chunk.size,
+                                dataOffset + qint64(sizeof(uint32_t)),
+                                qMin(dataOffset + qint64(chunk.size), parentEnd),
+                                chunk.flags);
+    }
+    return table.append(parent, chunk.fourcc, 0, chunk.offset, chunk.size, chunk.flags);
+}
+
+namespace {
+
+// true every CancelBatchSize calls once cancelled is set
+class CancelCheck
+{
+public:
+    explicit CancelCheck(const std::atomic<bool> &cancelled)
+        : m_cancelled(cancelled)
+    {}
+
+    bool operator()()
+    {
+        return ++m_count % CancelBatchSize == 0 && m_cancelled.load(std::memory_order_relaxed);
+    }
+
+private:
+    const std::atomic<bool> &m_cancelled;
+    int m_count{0};
+};
+
+// Scans the children of the list n, which are appended to the table
+template<typename Container>
+void scanListChildren(const uint8_t *buffer, qint64 length, ChunkTable &table, int32_t n,
+                      const std::atomic<bool> &cancelled)
+{
+    const qint64 from = qint64(table.listNode(n).nextChild);
+    const qint64 end = qint64(table.listNode(n).childrenEnd);
+    CancelCheck isCancelled(cancelled);
+    const qint64 next = RiffScanner::scanChildren<Container>(buffer, from, end, [&](const ChunkRecord &record) {
+        RiffScanner::appendRecord(table, n, record, length);
+        return !isCancelled();
+    });
+    table.listNode(n).nextChild = quint64(next);
+}
+
+// Lists are appended to the table as they are found, so walking it in
+// order from the first one reaches every list after its parent, without
+// recursion
+template<typename Container>
+void scanLists(const uint8_t *buffer, qint64 length, ChunkTable &table, int32_t first,
+               const std::atomic<bool> &cancelled)
+{
+    for (int32_t n = first; n <= table.count(); ++n) {
+        if (cancelled.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (table.isList(n)) {
+            scanListChildren<Container>(buffer, length, table, n, cancelled);
+        }
+    }
+}
+
+// A list scanned with its whole subtree into a table of its own, whose
+// root stands for the list
+struct SubtreeScan
+{
+    ChunkTable table;
+
+    quint64 size() const
+    {
+        const ListNode &root = table.listNode(ChunkTable::Root);
+        return root.childrenEnd - root.nextChild;
+    }
+};
+
+template<typename Container>
+class SubtreeTask : public QRunnable
+{
+public:
+    SubtreeTask(const uint8_t *buffer, qint64 length, ChunkTable *table, const std::atomic<bool> &cancelled,
+                QSemaphore *done)
+        : m_buffer(buffer)
+        , m_length(length)
+        , m_table(table)
+        , m_cancelled(cancelled)
+        , m_done(done)
+    {}
+
+    void run() override
+    {
+        ProfileScope scope("scan subtree");
+        scanLists<Container>(m_buffer, m_length, *m_table, ChunkTable::Root, m_cancelled);
+        scope.setArg(0, "chunks", m_table->count());
+        m_done->release();
+    }
+
+private:
+    const uint8_t *m_buffer;
+    qint64 m_length;
+    ChunkTable *m_table;
+    const std::atomic<bool> &m_cancelled;
+    QSemaphore *m_done;
+};
+
+// Scans every list below the top level containers already in the table,
+// on the calling thread for small files, otherwise on the pool
+template<typename Container>
+void scanNestedLists(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool,
+                     const std::atomic<bool> &cancelled)
+{
+    if (pool == nullptr || length < MinParallelSize) {
+        scanLists<Container>(buffer, length, table, 1, cancelled);
+        return;
+    }
+
+    // The lists are scanned here until they are small enough to be split
+    // off: about four subtrees per thread, so that the pool keeps busy
+    // while the biggest ones finish.
+    const qint64 splitSize = qMax(length / (4 * qMax(1, pool->maxThreadCount())), MinSubtreeSize);
+    std::vector<int32_t> subtrees;
+    for (int32_t n = 1; n <= table.count(); ++n) {
+        if (cancelled.load(std::memory_order_relaxed)) {
+            return;
+        }
+        if (!table.isList(n)) {
+            continue;
+        }
+        const ListNode &list = table.listNode(n);
+        if (qint64(list.childrenEnd - list.nextChild) <= splitSize) {
+            subtrees.push_back(n);
+        } else {
+            scanListChildren<Container>(buffer, length, table, n, cancelled);
+        }
+    }
+
+    // the biggest subtrees are started first, and they are moved into the
+    // table in file order once all of them are done
+    std::vector<SubtreeScan> scans(subtrees.size());
+    std::vector<size_t> bySize(subtrees.size());
+    for (size_t i = 0; i < subtrees.size(); ++i) {
+        const ListNode &list = table.listNode(subtrees[i]);
+        scans[i].table.listNode(ChunkTable::Root).nextChild = list.nextChild;
+        scans[i].table.listNode(ChunkTable::Root).childrenEnd = list.childrenEnd;
+        bySize[i] = i;
+    }
+    std::sort(bySize.begin(), bySize.end(), [&](size_t a, size_t b) {
+        return scans[a].size() > scans[b].size();
+    });
+    QSemaphore done;
+    for (const size_t i : bySize) {
+        pool->start(new SubtreeTask<Container>(buffer, length, &scans[i].table, cancelled, &done));
+    }
+    done.acquire(int(scans.size()));
+    for (size_t i = 0; i < subtrees.size(); ++i) {
+        table.appendSubtree(subtrees[i], scans[i].table);
+    }
+}
+
+} // namespace
+
+void RiffScanner::scanTree(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool)
+{
+    scanTree(buffer, length, table, pool, NeverCancelled);
+}
+
+void RiffScanner::scanTree(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool,
+                           const std::atomic<bool> &cancelled)
+{
+    table.clear();
+    const Format fileFormat = format(buffer, length);
+    if (fileFormat == Format::Unknown) {
+        return;
+    }
+    dispatch(fileFormat, [&](auto container) {
+        scanTree<decltype(container)>(buffer, length, table, pool, cancelled);
+    });
+}
+
+template<typename Container>
+void RiffScanner::scanTree(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool,
+                           const std::atomic<bool> &cancelled)
+{
+    table.listNode(ChunkTable::Root).childrenEnd = quint64(length);
+    CancelCheck isCancelled(cancelled);
+    const qint64 next = scanContainers<Container>(buffer, 0, length, [&](const ChunkRecord &record) {
+        appendRecord(table, ChunkTable::Root, record, length);
+        return !isCancelled();
+    });
+    table.listNode(ChunkTable::Root).nextChild = quint64(next);
+    scanNestedLists<Container>(buffer, length, table, pool, cancelled);
+}
+
+bool RiffScanner::readEmbeddedContainer(const uint8_t *buffer, qint64 pos, qint64 length, ChunkRecord &record)
+{
+    using Container = riff::RiffFormat;
+    // read as a file of its own, so that the ds64 chunk of RF64 is found
+    const uint8_t *start = buffer + pos;
+    const qint64 available = length - pos;
+    if (available < HeaderSize + qint64(sizeof(uint32_t))) {
+        return false;
+    }
+    const quint32 fourcc = riff::readFourcc(start);
+    const quint32 listType = riff::readFourcc(start + HeaderSize);
+    const quint64 size = declaredSize<Container>(start, 0, available);
+    if (!Container::isContainer(fourcc) || !isPrintable(listType) || size == PlaceholderSize
+        || size <= sizeof(uint32_t)) {
+        return false;
+    }
+    // a stream cut by the end of the file keeps what is left of it
+    ChunkRecord container{fourcc, listType, pos, size, 0, true};
+    if (size > quint64(available - HeaderSize)) {
+        container.size = quint64(available - HeaderSize);
+        container.flags = ChunkNode::Overrun;
+    }
+    // The first children must be chunks, and the very first one must fit:
+    // the bytes after the id of a "RIFF" found in text read as a size over
+    // 512 MiB, which only the big data chunks that come later ever have.
+    int count = 0;
+    bool valid = true;
+    scanChildren<Container>(start,
+                            HeaderSize + qint64(sizeof(uint32_t)),
+                            HeaderSize + qint64(container.size),
+                            [&](const ChunkRecord &child) {
+                                valid = !(child.flags & ChunkNode::Damaged)
+                                        && (count > 0 || !(child.flags & ChunkNode::Overrun));
+                                return valid && ++count < CarveProbeCount;
+                            });
+    if (!valid || count == 0) {
+        return false;
+    }
+    record = container;
+    return true;
+}
+
+namespace {
+
+// the containers that start between from and to
+void carveSlice(const uint8_t *buffer, qint64 from, qint64 to, qint64 length, QVector<ChunkRecord> &found,
+                const std::atomic<bool> &cancelled)
+{
+    const QByteArray ids[]{QByteArrayLiteral("RIFF"), QByteArrayLiteral("RF64"), QByteArrayLiteral("BW64")};
+    std::vector<qint64> candidates;
+    for (qint64 block = from; block < to && !cancelled.load(std::memory_order_relaxed); block += CarveBlockSize) {
+        const qint64 blockEnd = qMin(block + CarveBlockSize, to);
+        const uint8_t *end = buffer + qMin(blockEnd + qint64(sizeof(uint32_t)) - 1, length);
+        candidates.clear();
+        for (const QByteArray &id : ids) {
+            for (const uint8_t *pos = buffer + block;; ++pos) {
+                pos = PatternSearch::find(pos, end, id);
+                if (pos == end) {
+                    break;
+                }
+                candidates.push_back(pos - buffer);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (const qint64 pos : candidates) {
+            ChunkRecord record;
+            if (RiffScanner::readEmbeddedContainer(buffer, pos, length, record)) {
+                found.append(record);
+            }
+        }
+    }
+}
+
+class CarveTask : public QRunnable
+{
+public:
+    CarveTask(const uint8_t *buffer, qint64 from, qint64 to, qint64 length, QVector<ChunkRecord> *found,
+              const std::atomic<bool> &cancelled, QSemaphore *done)
+        : m_buffer(buffer)
+        , m_from(from)
+        , m_to(to)
+        , m_length(length)
+        , m_found(found)
+        , m_cancelled(cancelled)
+        , m_done(done)
+    {}
+
+    void run() override
+    {
+        ProfileScope scope("carve slice");
+        scope.setArg(0, "bytes", m_to - m_from);
+        carveSlice(m_buffer, m_from, m_to, m_length, *m_found, m_cancelled);
+        scope.setArg(1, "containers", m_found->size());
+        m_done->release();
+    }
+
+private:
+    const uint8_t *m_buffer;
+    qint64 m_from;
+    qint64 m_to;
+    qint64 m_length;
+    QVector<ChunkRecord> *m_found;
+    const std::atomic<bool> &m_cancelled;
+    QSemaphore *m_done;
+};
+
+QVector<ChunkRecord> carve(const uint8_t *buffer, qint64 from, qint64 length, QThreadPool *pool,
+                           const std::atomic<bool> &cancelled)
+{
+    ProfileScope scope("carve");
+    scope.setArg(0, "bytes", length - from);
+    std::vector<QVector<ChunkRecord>> slices;
+    if (length > from) {
+        slices.resize(size_t((length - from + CarveSliceSize - 1) / CarveSliceSize));
+    }
+    if (pool == nullptr || length - from < MinParallelSize) {
+        for (size_t i = 0; i < slices.size(); ++i) {
+            const qint64 begin = from + qint64(i) * CarveSliceSize;
+            carveSlice(buffer, begin, qMin(begin + CarveSliceSize, length), length, slices[i], cancelled);
+        }
+    } else {
+        QSemaphore done;
+        for (size_t i = 0; i < slices.size(); ++i) {
+            const qint64 begin = from + qint64(i) * CarveSliceSize;
+            pool->start(new CarveTask(buffer,
+                                      begin,
+                                      qMin(begin + CarveSliceSize, length),
+                                      length,
+                                      &slices[i],
+                                      cancelled,
+                                      &done));
+        }
+        done.acquire(int(slices.size()));
+    }
+
+    // the ids found inside a container are its children, or its data
+    QVector<ChunkRecord> containers;
+    qint64 end = from;
+    for (const QVector<ChunkRecord> &found : slices) {
+        for (const ChunkRecord &record : found) {
+            if (record.offset >= end) {
+                containers.append(record);
+                end = record.offset + RiffScanner::HeaderSize + qint64(record.size + (record.size & 1));
+            }
+        }
+    }
+    scope.setArg(1, "containers", containers.size());
+    return containers;
+}
+
+} // namespace
+
+QVector<ChunkRecord> RiffScanner::carveContainers(const uint8_t *buffer, qint64 from, qint64 length,
+                                                  QThreadPool *pool)
+{
+    return carve(buffer, from, length, pool, NeverCancelled);
+}
+
+void RiffScanner::carveTree(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool)
+{
+    carveTree(buffer, length, table, pool, NeverCancelled);
+}
+
+void RiffScanner::carveTree(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool,
+                            const std::atomic<bool> &cancelled)
+{
+    table.clear();
+    table.listNode(ChunkTable::Root).childrenEnd = quint64(length);
+    for (const ChunkRecord &record : carve(buffer, 0, length, pool, cancelled)) {
+        appendRecord(table, ChunkTable::Root, record, length);
+    }
+    table.listNode(ChunkTable::Root).nextChild = quint64(length);
+    scanNestedLists<riff::RiffFormat>(buffer, length, table, pool, cancelled);
+}
+
+void RiffScanner::scanList(int listId, qint64 from, qint64 end, int maxCount, int generation)
+{
+    ProfileScope scope("scan list");
+    end = qMin(end, m_length);
+    // neither a range from a damaged index cache nor a request queued
+    // before a cancel is read: the list stays as it is
+    if (from < 0 || from > end || generation != m_generation.load()) {
+        emit listScanned(listId, from);
+        return;
+    }
+    const qint64 total = end - from;
+    int count = 0;
+    m_timer.start();
+    auto visit = [&](const ChunkRecord &record) {
+        m_batch.append(record);
+        ++count;
+        if (m_batch.size() >= MaxBatchSize || m_timer.elapsed() >= MaxBatchInterval) {
+            flush(listId, qMin(record.offset, end) - from, total);
+        }
+        return count < maxCount && generation == m_generation.load();
+    };
+    const qint64 next = m_reader ? scanChildren(m_format, m_reader.get(), from, end, visit)
+                                 : scanChildren(m_format, m_buffer, from, end, visit);
+    flush(listId, qMin(next, end) - from, total);
+    scope.setArg(0, "chunks", count);
+    scope.setArg(1, "bytes", qMin(next, end) - from);
+    emit listScanned(listId, next);
+}
+
+void RiffScanner::flush(int listId, qint64 done, qint64 total)
+{
+    if (!m_batch.isEmpty()) {
+        emit chunksFound(listId, m_batch);
+        m_batch.clear();
+    }
+    emit progress(done, total);
+    m_timer.restart();
+}
@@ -0,0 +1,264 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef RIFFSCANNER_H
+#define RIFFSCANNER_H
+
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <QObject>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+#include "chunktable.h"
+#include "filewindows.h"
+#include "riff.h"
+
+class QThreadPool;
+
+struct ChunkRecord
+{
+    quint32 fourcc;
+    quint32 listType;
+    qint64 offset;
+    quint64 size;
+    quint32 flags; // ChunkNode::Flags
+    bool isList;
+};
+
+Q_DECLARE_METATYPE(QVector<ChunkRecord>)
+
+class RiffScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    // the containers read, each one with its own instance of the scanner
+    enum class Format { Unknown, Riff, Rifx, Iff };
+
+    explicit RiffScanner(const uint8_t *buffer, qint64 length, QObject *parent = nullptr);
+    // reads the file a window at a time, the windows outlive the scanner
+    RiffScanner(FileWindows *windows, qint64 length, QObject *parent = nullptr);
+
+    int generation() const;
+    void cancel();
+
+    static constexpr qint64 HeaderSize{2 * sizeof(uint32_t)};
+    static constexpr quint32 PlaceholderSize{0xFFFFFFFF};
+    // larger 64-bit sizes cannot be right, and would overflow the offsets
+    static constexpr quint64 MaxSize{quint64(1) << 62};
+
+    static Format format(const uint8_t *buffer, qint64 length);
+    static Format format(FileWindows::Reader *reader, qint64 length);
+    static bool isRiff(const uint8_t *buffer, qint64 length);
+    static bool isPrintable(quint32 fourcc);
+    static ChunkRecord readChunk(Format format, const uint8_t *buffer, qint64 offset, qint64 end);
+    static ChunkRecord readChunk(Format format, FileWindows::Reader *reader, qint64 offset, qint64 end);
+    static int32_t appendRecord(ChunkTable &table, int32_t parent, const ChunkRecord &chunk, qint64 length);
+    // with a pool, the subtrees of big files are scanned in parallel
+    static void scanTree(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool = nullptr);
+    // the same, giving up as soon as cancelled is set, the table incomplete
+    static void scanTree(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool,
+                         const std::atomic<bool> &cancelled);
+
+    // Carving: the RIFF, RF64 and BW64 containers embedded anywhere in a
+    // file, like WAV or AVI streams in archives or disk images, become the
+    // top level chunks, in file order and without overlaps.
+    static bool readEmbeddedContainer(const uint8_t *buffer, qint64 pos, qint64 length, ChunkRecord &record);
+    static QVector<ChunkRecord> carveContainers(const uint8_t *buffer, qint64 from, qint64 length,
+                                                QThreadPool *pool = nullptr);
+    static void carveTree(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool = nullptr);
+    static void carveTree(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool,
+                          const std::atomic<bool> &cancelled);
+
+    // through the mapping of the whole file, or a window at a time
+    template<typename Visitor>
+    static qint64 scanChildren(Format format, const uint8_t *buffer, qint64 from, qint64 end, Visitor visit);
+    template<typename Visitor>
+    static qint64 scanChildren(Format format, FileWindows::Reader *reader, qint64 from, qint64 end, Visitor visit);
+    template<typename Visitor>
+    static qint64 scanContainers(Format format, const uint8_t *buffer, qint64 from, qint64 length, Visitor visit);
+    template<typename Visitor>
+    static qint64 scanContainers(Format format, FileWindows::Reader *reader, qint64 from, qint64 length,
+                                 Visitor visit);
+
+    // The same for a container known at compile time, one of the riff.h
+    // formats: the byte order and the list ids cost no runtime branches.
+    // The file is read through Bytes, a const uint8_t * to the mapping of
+    // the whole file or a FileWindows::Reader *.
+    template<typename Container, typename Bytes>
+    static ChunkRecord readChunk(Bytes buffer, qint64 offset, qint64 end);
+    template<typename Container, typename Bytes>
+    static quint64 declaredSize(Bytes buffer, qint64 offset, qint64 end);
+    template<typename Container, typename Bytes>
+    static quint64 effectiveSize(Bytes buffer, const ChunkRecord &chunk, qint64 end);
+    template<typename Container, typename Bytes>
+    static bool hasChildAcross(Bytes buffer, const ChunkRecord &list, qint64 declaredEnd, qint64 end);
+    template<typename Bytes>
+    static bool isPlausibleHeader(Bytes buffer, qint64 pos, qint64 end);
+    template<typename Container, typename Bytes>
+    static bool isValidChunk(Bytes buffer, qint64 pos, qint64 end);
+    template<typename Container, typename Bytes>
+    static qint64 resync(Bytes buffer, qint64 from, qint64 end);
+    template<typename Container>
+    static void scanTree(const uint8_t *buffer, qint64 length, ChunkTable &table, QThreadPool *pool,
+                         const std::atomic<bool> &cancelled);
+    template<typename Container, typename Bytes, typename Visitor>
+    static qint64 scanChildren(Bytes buffer, qint64 from, qint64 end, Visitor visit);
+    template<typename Container, typename Bytes, typename Visitor>
+    static qint64 scanContainers(Bytes buffer, qint64 from, qint64 length, Visitor visit);
+
+    // the size bytes at pos
+    static const uint8_t *bytesAt(const uint8_t *buffer, qint64 pos, qint64 size)
+    {
+        Q_UNUSED(size)
+        return buffer + pos;
+    }
+    static const uint8_t *bytesAt(FileWindows::Reader *reader, qint64 pos, qint64 size)
+    {
+        return reader->at(pos, size);
+    }
+
+    // calls function() with an instance of the container type of a format
+    template<typename Function>
+    static auto dispatch(Format format, Function function) -> decltype(function(riff::RiffFormat{}));
+
+public slots:
+    void scanList(int listId, qint64 from, qint64 end, int maxCount, int generation);
+
+signals:
+    void chunksFound(int listId, const QVector<ChunkRecord> &chunks);
+    void progress(qint64 done, qint64 total);
+    void listScanned(int listId, qint64 next);
+
+private:
+    void flush(int listId, qint64 done, qint64 total);
+
+    const uint8_t *m_buffer;
+    std::unique_ptr<FileWindows::Reader> m_reader;
+    qint64 m_length;
+    Format m_format;
+    QVector<ChunkRecord> m_batch;
+    QElapsedTimer m_timer;
+    std::atomic<int> m_generation{0};
+};
+
+template<typename Function>
+auto RiffScanner::dispatch(Format format, Function function) -> decltype(function(riff::RiffFormat{}))
+{
+    switch (format) {
+    case Format::Rifx:
+        return function(riff::RifxFormat{});
+    case Format::Iff:
+        return function(riff::IffFormat{});
+    default:
+        return function(riff::RiffFormat{});
+    }
+}
+
+template<typename Visitor>
+qint64 RiffScanner::scanChildren(Format format, const uint8_t *buffer, qint64 from, qint64 end, Visitor visit)
+{
+    return dispatch(format, [&](auto container) {
+        return scanChildren<decltype(container)>(buffer, from, end, visit);
+    });
+}
+
+template<typename Visitor>
+qint64 RiffScanner::scanChildren(Format format, FileWindows::Reader *reader, qint64 from, qint64 end, Visitor visit)
+{
+    return dispatch(format, [&](auto container) {
+        return scanChildren<decltype(container)>(reader, from, end, visit);
+    });
+}
+
+template<typename Visitor>
+qint64 RiffScanner::scanContainers(Format format, const uint8_t *buffer, qint64 from, qint64 length, Visitor visit)
+{
+    return dispatch(format, [&](auto container) {
+        return scanContainers<decltype(container)>(buffer, from, length, visit);
+    });
+}
+
+template<typename Visitor>
+qint64 RiffScanner::scanContainers(Format format, FileWindows::Reader *reader, qint64 from, qint64 length,
+                                   Visitor visit)
+{
+    return dispatch(format, [&](auto container) {
+        return scanContainers<decltype(container)>(reader, from, length, visit);
+    });
+}
+
+//
+// Reads the top level chunks from the start of the file, or from where a
+// previous call stopped, while they are containers: most files have only
+// one, but OpenDML AVI files larger than 1 GiB continue with RIFF(AVIX)
+// chunks. Returns the offset after the last one.
+//
+
+template<typename Container, typename Bytes, typename Visitor>
+qint64 RiffScanner::scanContainers(Bytes buffer, qint64 from, qint64 length, Visitor visit)
+{
+    qint64 pos = from;
+    while (pos + HeaderSize + qint64(sizeof(uint32_t)) <= length
+           && Container::isContainer(riff::readFourcc(bytesAt(buffer, pos, sizeof(uint32_t))))) {
+        const ChunkRecord record = readChunk<Container>(buffer, pos, length);
+        pos += HeaderSize + qint64(record.size + (record.size & 1));
+        if (!visit(record)) {
+            break;
+        }
+    }
+    return pos;
+}
+
+//
+// Reads the chunks between from and end, calling visit() for each one until
+// it returns false. Returns the offset of the next chunk to be read, which
+// is end or beyond when the whole range has been read: when the last chunk
+// is still being written, reading resumes after it once the range grows.
+// Nested lists are not entered.
+//
+// The end must not exceed the mapped length: nothing is read beyond it.
+// Sizes going beyond the end are cut, and bytes that are not a chunk
+// header are reported as a single damaged chunk, skipped up to the next
+// plausible header.
+//
+
+template<typename Container, typename Bytes, typename Visitor>
+qint64 RiffScanner::scanChildren(Bytes buffer, qint64 from, qint64 end, Visitor visit)
+{
+    qint64 pos = from;
+    quint32 resynced = 0;
+    while (pos + HeaderSize <= end) {
+        const quint32 type = riff::readFourcc(bytesAt(buffer, pos, sizeof(uint32_t)));
+        if (Container::isList(type) && pos + HeaderSize + qint64(sizeof(uint32_t)) > end) {
+            break;
+        }
+        if (!isPrintable(type) && !isValidChunk<Container>(buffer, pos, end)) {
+            const qint64 next = resync<Container>(buffer, pos + 1, end);
+            const qint64 skipped = qMax(next - pos - HeaderSize, qint64(0));
+            const ChunkRecord damaged{type, 0, pos, quint64(skipped), ChunkNode::Damaged, false};
+            pos = next;
+            resynced = ChunkNode::Resynced;
+            if (!visit(damaged)) {
+                break;
+            }
+            continue;
+        }
+        ChunkRecord record = readChunk<Container>(buffer, pos, end);
+        record.flags |= resynced;
+        resynced = 0;
+        // the next chunk is 16-bit aligned, after the declared size even if
+        // it was cut, so that a chunk being written resumes when the file grows
+        const quint64 size = record.flags & ChunkNode::Overrun ? declaredSize<Container>(buffer, pos, end)
+                                                               : record.size;
+        pos += HeaderSize + qint64(size + (size & 1));
+        if (!visit(record)) {
+            break;
+        }
+    }
+    return pos;
+}
+
+#endif // RIFFSCANNER_H
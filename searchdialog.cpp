@@ -0,0 +1,178 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QStringList>
+#include <QVBoxLayout>
+
+#include "riffscanner.h"
+#include "searchdialog.h"
+#include "treemodel.h"
+
+namespace {
+// sorted by offset, not by the text shown
+class HitItem : public QTreeWidgetItem
+{
+public:
+    explicit HitItem(qint64 offset) : m_offset(offset) {}
+
+    qint64 offset() const { return m_offset; }
+
+    bool operator<(const QTreeWidgetItem &other) const override
+    {
+        return m_offset < static_cast<const HitItem &>(other).m_offset;
+    }
+
+private:
+    qint64 m_offset;
+};
+} // namespace
+
+SearchDialog::SearchDialog(QTreeView *tree, QWidget *parent)
+    : QDialog(parent)
+    , m_tree(tree)
+    , m_search(new PatternSearch(this))
+{
+    setWindowTitle(tr("Search File"));
+    resize(520, 480);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    QFormLayout *formLayout = new QFormLayout;
+    m_modeBox = new QComboBox(this);
+    m_modeBox->addItem(tr("Text"), int(PatternSearch::Mode::Text));
+    m_modeBox->addItem(tr("Hex bytes"), int(PatternSearch::Mode::Hex));
+    m_modeBox->addItem(tr("Chunk id"), int(PatternSearch::Mode::Fourcc));
+    formLayout->addRow(tr("Search for:"), m_modeBox);
+    m_patternEdit = new QLineEdit(this);
+    formLayout->addRow(tr("Pattern:"), m_patternEdit);
+    mainLayout->addLayout(formLayout);
+    m_scopeBox = new QCheckBox(tr("Only in the chunk selected in the tree"), this);
+    mainLayout->addWidget(m_scopeBox);
+
+    m_results = new QTreeWidget(this);
+    m_results->setRootIsDecorated(false);
+    m_results->setHeaderLabels({tr("Offset"), tr("Chunk")});
+    mainLayout->addWidget(m_results, 1);
+    m_status = new QLabel(this);
+    mainLayout->addWidget(m_status);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    m_searchButton = buttonBox->addButton(tr("&Search"), QDialogButtonBox::ActionRole);
+    m_stopButton = buttonBox->addButton(tr("S&top"), QDialogButtonBox::ActionRole);
+    m_searchButton->setDefault(true);
+    m_stopButton->setEnabled(false);
+    connect(m_searchButton, &QPushButton::clicked, this, &SearchDialog::search);
+    connect(m_stopButton, &QPushButton::clicked, this, &SearchDialog::stop);
+    connect(m_patternEdit, &QLineEdit::returnPressed, this, &SearchDialog::search);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttonBox);
+
+    connect(m_results, &QTreeWidget::itemActivated, this, &SearchDialog::activateHit);
+    connect(m_results, &QTreeWidget::itemClicked, this, &SearchDialog::activateHit);
+    connect(m_search, &PatternSearch::hitsFound, this, &SearchDialog::addHits);
+    connect(m_search, &PatternSearch::progress, this, &SearchDialog::searchProgress);
+    connect(m_search, &PatternSearch::finished, this, &SearchDialog::searchFinished);
+}
+
+void SearchDialog::setFile(const uint8_t *buffer, qint64 length, TreeModel *model)
+{
+    m_search->setBuffer(buffer, length);
+    m_searchButton->setEnabled(buffer != nullptr);
+    m_stopButton->setEnabled(false);
+    if (model != m_model) {
+        m_model = model;
+        m_results->clear();
+        m_status->clear();
+    }
+}
+
+void SearchDialog::search()
+{
+    if (m_model == nullptr) {
+        return;
+    }
+    const auto mode = PatternSearch::Mode(m_modeBox->currentData().toInt());
+    const QByteArray pattern = PatternSearch::parsePattern(mode, m_patternEdit->text());
+    if (pattern.isEmpty()) {
+        m_status->setText(tr("The pattern is not valid"));
+        return;
+    }
+    qint64 from = 0;
+    qint64 to = m_model->chunks().listNode(ChunkTable::Root).childrenEnd;
+    const QModelIndex chunk = m_tree->currentIndex();
+    if (m_scopeBox->isChecked() && chunk.isValid()) {
+        from = m_model->data(chunk.sibling(chunk.row(), 1), Qt::DisplayRole).toLongLong();
+        to = from + RiffScanner::HeaderSize
+             + m_model->data(chunk.sibling(chunk.row(), 2), Qt::DisplayRole).toLongLong();
+    }
+    m_results->clear();
+    m_results->setSortingEnabled(false);
+    m_patternSize = pattern.size();
+    m_status->setText(tr("Searching..."));
+    m_searchButton->setEnabled(false);
+    m_stopButton->setEnabled(true);
+    m_search->start(pattern, from, to);
+}
+
+void SearchDialog::stop()
+{
+    m_search->cancel();
+    m_results->sortItems(0, Qt::AscendingOrder);
+    m_status->setText(tr("Stopped, %1 hits").arg(m_results->topLevelItemCount()));
+    m_searchButton->setEnabled(true);
+    m_stopButton->setEnabled(false);
+}
+
+void SearchDialog::addHits(const QVector<qint64> &offsets)
+{
+    QList<QTreeWidgetItem *> items;
+    items.reserve(offsets.size());
+    for (const qint64 offset : offsets) {
+        auto *item = new HitItem(offset);
+        item->setText(0, QString::number(offset));
+        item->setTextAlignment(0, Qt::AlignRight);
+        item->setText(1, chunkPath(offset));
+        items.append(item);
+    }
+    m_results->addTopLevelItems(items);
+}
+
+void SearchDialog::searchProgress(qint64 done, qint64 total)
+{
+    m_status->setText(tr("Searching... %1%, %2 hits")
+                          .arg(total > 0 ? done * 100 / total : 100)
+                          .arg(m_results->topLevelItemCount()));
+}
+
+void SearchDialog::searchFinished(qint64 hits)
+{
+    m_results->sortItems(0, Qt::AscendingOrder);
+    m_results->resizeColumnToContents(0);
+    if (hits > m_results->topLevelItemCount()) {
+        m_status->setText(tr("%1 hits, only the first %2 found are shown")
+                              .arg(hits)
+                              .arg(m_results->topLevelItemCount()));
+    } else {
+        m_status->setText(tr("%1 hits").arg(hits));
+    }
+    m_searchButton->setEnabled(true);
+    m_stopButton->setEnabled(false);
+}
+
+void SearchDialog::activateHit(QTreeWidgetItem *item)
+{
+    if (item != nullptr) {
+        emit hitActivated(static_cast<HitItem *>(item)->offset(), m_patternSize);
+    }
+}
+
+// the chunks holding the offset, as far as the tree has been scanned
+QString SearchDialog::chunkPath(qint64 offset) const
+{
+    QStringList path;
+    for (QModelIndex index = m_model->indexAt(offset); index.isValid(); index = index.parent()) {
+        path.prepend(m_model->data(index, Qt::DisplayRole).toString());
+    }
+    return path.join(QLatin1Char('/'));
+}
@@ -0,0 +1,56 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SEARCHDIALOG_H
+#define SEARCHDIALOG_H
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTreeView>
+#include <QTreeWidget>
+
+#include "patternsearch.h"
+
+class TreeModel;
+
+class SearchDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit SearchDialog(QTreeView *tree, QWidget *parent = nullptr);
+
+    // the file searched, and the model giving the chunk of each hit; a
+    // running search is stopped, the hits are kept while the model is the same
+    void setFile(const uint8_t *buffer, qint64 length, TreeModel *model);
+
+signals:
+    void hitActivated(qint64 offset, qint64 length);
+
+private slots:
+    void search();
+    void stop();
+    void addHits(const QVector<qint64> &offsets);
+    void searchProgress(qint64 done, qint64 total);
+    void searchFinished(qint64 hits);
+    void activateHit(QTreeWidgetItem *item);
+
+private:
+    QString chunkPath(qint64 offset) const;
+
+    QTreeView *m_tree;
+    TreeModel *m_model{nullptr};
+    PatternSearch *m_search;
+    qint64 m_patternSize{0};
+    QComboBox *m_modeBox;
+    QLineEdit *m_patternEdit;
+    QCheckBox *m_scopeBox;
+    QPushButton *m_searchButton;
+    QPushButton *m_stopButton;
+    QTreeWidget *m_results;
+    QLabel *m_status;
+};
+
+#endif // SEARCHDIALOG_H
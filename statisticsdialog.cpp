@@ -0,0 +1,222 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <QDialogButtonBox>
+#include <QElapsedTimer>
+#include <QLocale>
+#include <QRunnable>
+#include <QVBoxLayout>
+
+#include "profiler.h"
+#include "riff.h"
+#include "riffscanner.h"
+#include "statisticsdialog.h"
+
+namespace {
+enum Column {
+    KindColumn,
+    CountColumn,
+    BytesColumn,
+    PercentColumn,
+    MinColumn,
+    MaxColumn,
+    MeanColumn,
+    DepthColumn,
+    ChildrenColumn,
+    PerListColumn,
+    ColumnCount
+};
+
+// sorted by the numbers, not by the text shown
+class StatsItem : public QTreeWidgetItem
+{
+public:
+    void setNumber(int column, double value, const QString &text)
+    {
+        setText(column, text);
+        setTextAlignment(column, Qt::AlignRight);
+        setData(column, Qt::UserRole, value);
+    }
+
+    bool operator<(const QTreeWidgetItem &other) const override
+    {
+        const int column = treeWidget()->sortColumn();
+        if (column == KindColumn) {
+            return text(column) < other.text(column);
+        }
+        return data(column, Qt::UserRole).toDouble() < other.data(column, Qt::UserRole).toDouble();
+    }
+};
+} // namespace
+
+class StatisticsDialog::Job : public QRunnable
+{
+public:
+    Job(StatisticsDialog *dialog, int generation, const uint8_t *buffer, qint64 length, bool carved)
+        : m_dialog(dialog)
+        , m_generation(generation)
+        , m_buffer(buffer)
+        , m_length(length)
+        , m_carved(carved)
+    {}
+
+    void run() override
+    {
+        ProfileScope scope("file statistics");
+        QElapsedTimer timer;
+        timer.start();
+        ChunkTable table;
+        QThreadPool *pool = QThreadPool::globalInstance();
+        if (m_carved) {
+            RiffScanner::carveTree(m_buffer, m_length, table, pool, m_dialog->m_cancelled);
+        } else {
+            RiffScanner::scanTree(m_buffer, m_length, table, pool, m_dialog->m_cancelled);
+        }
+        if (m_dialog->m_cancelled) {
+            return;
+        }
+        const std::vector<ChunkStats> stats = ChunkStats::collect(table, pool);
+        StatisticsDialog *dialog = m_dialog;
+        const int generation = m_generation;
+        const int chunks = table.count();
+        const qint64 elapsed = timer.elapsed();
+        QMetaObject::invokeMethod(
+            dialog,
+            [=] { dialog->jobDone(generation, stats, chunks, elapsed); },
+            Qt::QueuedConnection);
+    }
+
+private:
+    StatisticsDialog *m_dialog;
+    int m_generation;
+    const uint8_t *m_buffer;
+    qint64 m_length;
+    bool m_carved;
+};
+
+StatisticsDialog::StatisticsDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("File Statistics"));
+    resize(760, 480);
+    // the job waits for the scan on the global pool
+    m_pool.setMaxThreadCount(1);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    m_results = new QTreeWidget(this);
+    m_results->setRootIsDecorated(false);
+    m_results->setColumnCount(ColumnCount);
+    m_results->setHeaderLabels({tr("Chunk"),
+                                tr("Count"),
+                                tr("Bytes"),
+                                tr("% of file"),
+                                tr("Min size"),
+                                tr("Max size"),
+                                tr("Mean size"),
+                                tr("Depth"),
+                                tr("Children"),
+                                tr("Per list")});
+    mainLayout->addWidget(m_results, 1);
+    m_status = new QLabel(this);
+    mainLayout->addWidget(m_status);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+    m_refreshButton = buttonBox->addButton(tr("&Refresh"), QDialogButtonBox::ActionRole);
+    connect(m_refreshButton, &QPushButton::clicked, this, &StatisticsDialog::refresh);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttonBox);
+}
+
+StatisticsDialog::~StatisticsDialog()
+{
+    stop();
+}
+
+void StatisticsDialog::setFile(const uint8_t *buffer, qint64 length, bool carved)
+{
+    stop();
+    m_results->clear();
+    m_status->clear();
+    m_buffer = buffer;
+    m_length = length;
+    m_carved = carved;
+    m_refreshButton->setEnabled(buffer != nullptr);
+    if (isVisible()) {
+        refresh();
+    }
+}
+
+void StatisticsDialog::refresh()
+{
+    stop();
+    if (m_buffer == nullptr) {
+        return;
+    }
+    m_status->setText(tr("Scanning..."));
+    m_refreshButton->setEnabled(false);
+    m_pool.start(new Job(this, m_generation, m_buffer, m_length, m_carved));
+}
+
+void StatisticsDialog::stop()
+{
+    // the result of a job still queued for the GUI thread is ignored, and
+    // the scan of one running gives up instead of being waited for
+    ++m_generation;
+    m_cancelled = true;
+    m_pool.clear();
+    m_pool.waitForDone();
+    m_cancelled = false;
+}
+
+void StatisticsDialog::jobDone(int generation, const std::vector<ChunkStats> &stats, int chunks, qint64 elapsed)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    const QLocale locale;
+    m_results->setSortingEnabled(false);
+    m_results->clear();
+    QList<QTreeWidgetItem *> items;
+    for (const ChunkStats &kind : stats) {
+        auto *item = new StatsItem;
+        if (kind.isDamaged) {
+            item->setText(KindColumn, tr("(damaged)"));
+        } else if (kind.isList) {
+            item->setText(KindColumn,
+                          QString("%1(%2)").arg(riff::fourccToQString(kind.fourcc),
+                                                riff::fourccToQString(kind.listType)));
+        } else {
+            item->setText(KindColumn, riff::fourccToQString(kind.fourcc));
+        }
+        const double mean = double(kind.bytes) / double(kind.count);
+        const double percent = m_length > 0 ? 100.0 * double(kind.bytes) / double(m_length) : 0.0;
+        item->setNumber(CountColumn, double(kind.count), locale.toString(kind.count));
+        item->setNumber(BytesColumn, double(kind.bytes), locale.formattedDataSize(qint64(kind.bytes)));
+        item->setNumber(PercentColumn, percent, locale.toString(percent, 'f', 1));
+        item->setNumber(MinColumn, double(kind.minSize), locale.toString(qint64(kind.minSize)));
+        item->setNumber(MaxColumn, double(kind.maxSize), locale.toString(qint64(kind.maxSize)));
+        item->setNumber(MeanColumn, mean, locale.toString(mean, 'f', 0));
+        item->setNumber(DepthColumn,
+                        kind.minDepth,
+                        kind.minDepth == kind.maxDepth ? QString::number(kind.minDepth)
+                                                       : QString("%1-%2").arg(kind.minDepth).arg(kind.maxDepth));
+        if (kind.isList) {
+            const double perList = double(kind.children) / double(kind.count);
+            item->setNumber(ChildrenColumn, double(kind.children), locale.toString(kind.children));
+            item->setNumber(PerListColumn, perList, locale.toString(perList, 'f', 1));
+        }
+        items.append(item);
+    }
+    m_results->addTopLevelItems(items);
+    m_results->setSortingEnabled(true);
+    m_results->sortItems(BytesColumn, Qt::DescendingOrder);
+    for (int column = 0; column < ColumnCount; ++column) {
+        m_results->resizeColumnToContents(column);
+    }
+    m_status->setText(tr("%1 chunks of %2 kinds in %3, counted in %4 ms")
+                          .arg(locale.toString(chunks))
+                          .arg(stats.size())
+                          .arg(locale.formattedDataSize(m_length))
+                          .arg(elapsed));
+    m_refreshButton->setEnabled(true);
+}
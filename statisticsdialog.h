@@ -0,0 +1,51 @@
+// Copyright (C) 2025-2026 Pedro López-Cabanillas
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef STATISTICSDIALOG_H
+#define STATISTICSDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QPushButton>
+#include <QThreadPool>
+#include <QTreeWidget>
+#include <atomic>
+#include <vector>
+
+#include "chunkstats.h"
+
+//
+// Summary of the open file by kind of chunk. The whole file is scanned in
+// the background, not only the lists expanded in the tree, and the table
+// is counted in parallel.
+//
+
+class StatisticsDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit StatisticsDialog(QWidget *parent = nullptr);
+    ~StatisticsDialog() override;
+
+    // the file summarized, carved or not like its tree; shown again when visible
+    void setFile(const uint8_t *buffer, qint64 length, bool carved);
+
+public slots:
+    void refresh();
+
+private:
+    class Job;
+    void jobDone(int generation, const std::vector<ChunkStats> &stats, int chunks, qint64 elapsed);
+    void stop();
+
+    const uint8_t *m_buffer{nullptr};
+    qint64 m_length{0};
+    bool m_carved{false};
+    QThreadPool m_pool;
+    std::atomic<bool> m_cancelled{false};
+    int m_generation{0};
+    QTreeWidget *m_results;
+    QLabel *m_status;
+    QPushButton *m_refreshButton;
+};
+
+#endif // STATISTICSDIALOG_H
@@ -9,81 +9,510 @@
     models.
 */
 
-#include <QApplication>
-#include <QFile>
-#include <QMessageBox>
+#include <QBrush>
+#include <QCoreApplication>
 #include <QStringList>
-#include <QVariantList>
+#include <QThreadPool>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
+#include "profiler.h"
 #include "riff.h"
-#include "treeitem.h"
 #include "treemodel.h"
 
+namespace {
+// Maximum number of children scanned by one fetchMore() call. Wider lists
+// are completed as the view scrolls down to their last fetched row.
+constexpr int FetchBatchSize{50000};
+// Worker threads scanning lists, when there are as many cores
+constexpr int MaxScanners{8};
+constexpr int ColumnCount{5};
+// Payloads hashed right away when painted, bigger ones are hashed in the
+// background; tens of microseconds at most.
+constexpr qint64 InlineHashSize{64 << 10};
+
+quint64 hashKey(int32_t node, int kind)
+{
+    return quint64(node) << 1 | quint64(kind);
+}
+} // namespace
+
 TreeModel::TreeModel(QObject *parent)
     : QAbstractItemModel(parent)
-    , rootItem(std::make_unique<TreeItem>(QVariantList{tr("Chunk"), tr("Offset"), tr("Size")}))
-{}
+    , m_hasher(new ChunkHasher(this))
+{
+    connect(m_hasher, &ChunkHasher::hashed, this, &TreeModel::hashFound);
+}
 
-TreeModel::~TreeModel() = default;
+TreeModel::~TreeModel()
+{
+    stopScanners();
+}
 
 int TreeModel::columnCount(const QModelIndex &parent) const
 {
-    if (parent.isValid())
-        return static_cast<TreeItem*>(parent.internalPointer())->columnCount();
-    return rootItem->columnCount();
+    Q_UNUSED(parent)
+    return ColumnCount;
 }
 
-bool TreeModel::loadData(uint8_t *buffer)
+bool TreeModel::loadData(const uint8_t *buffer, qint64 length, ChunkTable *cached, bool carve)
 {
+    ProfileScope scope("load model");
+    stopScanners();
     m_buffer = buffer;
-    riff::RiffChunk<> *chunk = reinterpret_cast<riff::RiffChunk<> *>(m_buffer);
-    if (!chunk->hasTypeRiff()) {
+    m_windows = nullptr;
+    m_reader.reset();
+    m_length = length;
+    m_carved = carve;
+    // the carved containers are all of the RIFF family
+    m_format = carve ? RiffScanner::Format::Riff : RiffScanner::format(m_buffer, m_length);
+    return load(cached);
+}
+
+bool TreeModel::loadWindows(FileWindows *windows)
+{
+    ProfileScope scope("load model");
+    stopScanners();
+    m_buffer = nullptr;
+    m_windows = windows;
+    m_reader.reset(new FileWindows::Reader(windows));
+    m_length = windows->size();
+    m_carved = false;
+    m_format = RiffScanner::format(m_reader.get(), m_length);
+    return load(nullptr);
+}
+
+bool TreeModel::load(ChunkTable *cached)
+{
+    if (m_format == RiffScanner::Format::Unknown) {
+        return false;
+    }
+
+    qRegisterMetaType<QVector<ChunkRecord>>();
+    // the hashes read the whole mapping, there are none with windows
+    m_hasher->setBuffer(m_buffer, m_buffer != nullptr ? m_length : 0);
+    dropHashes(true);
+    m_index.clear();
+
+    // Only the top level containers are read here. The children of every
+    // list are scanned on a worker thread the first time the list is
+    // expanded, and inserted into the model in batches as they arrive.
+    // Sibling lists are scanned by several workers at the same time.
+    startScanners();
+
+    if (cached != nullptr && cached->count() > 0) {
+        // a table restored from the index cache is shown as it is, the lists
+        // that were not scanned when it was saved are still fetched on demand
+        beginResetModel();
+        std::swap(m_table, *cached);
+        m_index.update(m_table);
+        endResetModel();
+        m_modified = false;
+    } else {
+        appendContainers(0);
+    }
+
+    return m_table.childCount(ChunkTable::Root) > 0;
+}
+
+bool TreeModel::extend(const uint8_t *buffer, qint64 length)
+{
+    // carved files are not followed: the containers are found by reading
+    // the whole file, not by chaining them from the start
+    if (m_workers.empty() || length < m_length || m_carved || m_windows != nullptr) {
         return false;
     }
+    ProfileScope scope("extend model");
+    scope.setArg(0, "bytes", length - m_length);
+
+    // The running scans read the previous mapping: they are stopped, their
+    // undelivered results dropped, and the lists resume after the last child
+    // already inserted.
+    stopScanners();
+    QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
+    std::vector<int32_t> refetch;
+    for (int32_t n = 1; n <= m_table.count(); ++n) {
+        if (m_table.isList(n) && m_table.listNode(n).fetching) {
+            ListNode &list = m_table.listNode(n);
+            list.nextChild = m_table.resumeOffset(list);
+            list.fetching = false;
+            refetch.push_back(n);
+        }
+    }
+    const bool wasLoading = m_pendingFetches > 0;
+    m_pendingFetches = 0;
+    m_fetchesCut = false;
+    m_buffer = buffer;
+    m_length = length;
+    startScanners();
+    // the hashes being computed read the previous mapping as well
+    m_hasher->setBuffer(m_buffer, m_length);
+    dropHashes(false);
 
-    beginResetModel();
-    traverseRiff(chunk->castTo<riff::RiffList<> >(), rootItem.get());
-    endResetModel();
+    // Only the last chunk of every list on the way to the end of the file
+    // may grow: their sizes are read again, since they may be placeholders
+    // or updated by the writer, and the lists already scanned continue.
+    qint64 parentEnd = m_length;
+    for (int32_t parent = ChunkTable::Root; m_table.childCount(parent) > 0;) {
+        const int32_t n = m_table.listNode(parent).children.back();
+        const ChunkNode &node = m_table.node(n);
+        if (node.flags & ChunkNode::Damaged) {
+            break;
+        }
+        const ChunkRecord chunk = RiffScanner::readChunk(m_format, m_buffer, qint64(node.offset), parentEnd);
+        const uint32_t flags = chunk.flags | (node.flags & ChunkNode::Resynced);
+        if (chunk.size != node.size || flags != node.flags) {
+            m_table.setSize(n, chunk.size, flags);
+            m_hashes.remove(hashKey(n, ChunkHash::Xxh64Hash));
+            m_hashes.remove(hashKey(n, ChunkHash::Crc32Hash));
+            emit dataChanged(createIndex(m_table.row(n), 0, quintptr(n)),
+                             createIndex(m_table.row(n), ColumnCount - 1, quintptr(n)));
+            m_modified = true;
+        }
+        // the scan of the parent resumes after the chunk, not inside it,
+        // even when the index cache saved it at the previous end of the file
+        if (parent != ChunkTable::Root) {
+            ListNode &parentList = m_table.listNode(parent);
+            const uint64_t chunkEnd = uint64_t(chunk.offset + RiffScanner::HeaderSize) + chunk.size + (chunk.size & 1);
+            parentList.nextChild = std::max(parentList.nextChild, chunkEnd);
+        }
+        if (!m_table.isList(n)) {
+            break;
+        }
+        ListNode &list = m_table.listNode(n);
+        list.childrenEnd = quint64(qMin(chunk.offset + RiffScanner::HeaderSize + qint64(chunk.size), parentEnd));
+        parentEnd = qint64(list.childrenEnd);
+        if (isScanned(n) && std::find(refetch.begin(), refetch.end(), n) == refetch.end()) {
+            refetch.push_back(n);
+        }
+        parent = n;
+    }
+    // new containers may follow the last one, like the RIFF(AVIX) chunks
+    // of an OpenDML file being recorded
+    const ChunkNode &last = m_table.node(m_table.listNode(ChunkTable::Root).children.back());
+    appendContainers(qint64(last.offset) + RiffScanner::HeaderSize + qint64(last.size + (last.size & 1)));
 
+    for (const int32_t n : refetch) {
+        fetchMore(indexOf(n));
+    }
+    if (wasLoading && m_pendingFetches == 0) {
+        emit loadFinished(true);
+    }
     return true;
 }
 
-void TreeModel::traverseRiff(const riff::RiffList<>::Chunk *listChunk, TreeItem *lastParent)
-{
-    qintptr lastPos = listChunk->offset(m_buffer);
-    lastParent->appendChild(
-        std::make_unique<TreeItem>(QVariantList{QString("%1(%2)")
-                                                    .arg(listChunk->typeToQString())
-                                                    .arg(listChunk->data->listTypeToQString()),
-                                                lastPos,
-                                                listChunk->size},
-                                   lastParent));
-
-    lastParent = lastParent->child(lastParent->childCount() - 1);
-
-    const riff::RiffChunk<> *child = listChunk->data->chunks;
-    const void *end = listChunk->dataEnd();
-    while (child < end) {
-        if (child->hasTypeList() || child->hasTypeRiff()) {
-            traverseRiff(child->castTo<riff::RiffList<> >(), lastParent);
-        } else {
-            lastPos = child->offset(m_buffer);
-            lastParent->appendChild(std::make_unique<TreeItem>(QVariantList{child->typeToQString(),
-                                                                            lastPos,
-                                                                            child->size},
-                                                               lastParent));
+bool TreeModel::isModified() const
+{
+    return m_modified;
+}
+
+bool TreeModel::isCarved() const
+{
+    return m_carved;
+}
+
+RiffScanner::Format TreeModel::format() const
+{
+    return m_format;
+}
+
+bool TreeModel::isLoading() const
+{
+    return m_pendingFetches > 0;
+}
+
+int TreeModel::chunkCount() const
+{
+    return m_table.count();
+}
+
+const ChunkTable &TreeModel::chunks() const
+{
+    return m_table;
+}
+
+const ChunkIndex &TreeModel::chunkIndex() const
+{
+    return m_index;
+}
+
+// the innermost chunk holding a byte of the file, among the lists fetched
+QModelIndex TreeModel::indexAt(qint64 offset) const
+{
+    return offset < 0 ? QModelIndex{} : indexOf(m_table.findChunk(quint64(offset)));
+}
+
+void TreeModel::cancelLoading()
+{
+    for (const Worker &worker : m_workers) {
+        worker.scanner->cancel();
+    }
+}
+
+void TreeModel::startScanners()
+{
+    const int count = qBound(1, QThread::idealThreadCount(), MaxScanners);
+    for (int i = 0; i < count; ++i) {
+        RiffScanner *scanner = m_windows != nullptr ? new RiffScanner(m_windows, m_length)
+                                                    : new RiffScanner(m_buffer, m_length);
+        Worker worker{new QThread(this), scanner, 0};
+        worker.thread->setObjectName("RiffScanner");
+        worker.scanner->moveToThread(worker.thread);
+        connect(worker.scanner, &RiffScanner::chunksFound, this, &TreeModel::appendChunks);
+        connect(worker.scanner, &RiffScanner::progress, this, &TreeModel::loadProgress);
+        connect(worker.scanner, &RiffScanner::listScanned, this, &TreeModel::listScanned);
+        worker.thread->start();
+        m_workers.push_back(worker);
+    }
+}
+
+void TreeModel::stopScanners()
+{
+    for (const Worker &worker : m_workers) {
+        worker.scanner->cancel();
+        worker.thread->quit();
+    }
+    for (const Worker &worker : m_workers) {
+        worker.thread->wait();
+        delete worker.scanner;
+        delete worker.thread;
+    }
+    m_workers.clear();
+    m_fetchWorkers.clear();
+}
+
+bool TreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if (parent.column() > 0)
+        return false;
+    const int32_t node = nodeOf(parent);
+    return m_table.isList(node) && (node != ChunkTable::Root || m_table.childCount(node) > 0);
+}
+
+bool TreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!parent.isValid() || m_workers.empty())
+        return false;
+    const int32_t node = nodeOf(parent);
+    if (!m_table.isList(node))
+        return false;
+    const ListNode &list = m_table.listNode(node);
+    return !list.fetching && list.nextChild < list.childrenEnd;
+}
+
+void TreeModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+    const int32_t node = nodeOf(parent);
+    ListNode &list = m_table.listNode(node);
+    list.fetching = true;
+    ++m_pendingFetches;
+    emit loadProgress(0, qint64(list.childrenEnd - list.nextChild));
+    // the worker with the fewest lists pending gets the next one
+    const auto worker = std::min_element(m_workers.begin(), m_workers.end(), [](const Worker &a, const Worker &b) {
+        return a.fetches < b.fetches;
+    });
+    ++worker->fetches;
+    m_fetchWorkers.insert(node, int(worker - m_workers.begin()));
+    QMetaObject::invokeMethod(worker->scanner,
+                              "scanList",
+                              Qt::QueuedConnection,
+                              Q_ARG(int, node),
+                              Q_ARG(qint64, qint64(list.nextChild)),
+                              Q_ARG(qint64, qint64(list.childrenEnd)),
+                              Q_ARG(int, FetchBatchSize),
+                              Q_ARG(int, worker->scanner->generation()));
+}
+
+bool TreeModel::isScanned(int32_t node) const
+{
+    // the children of a list start after its header and list type
+    const qint64 childrenBegin = qint64(m_table.node(node).offset) + RiffScanner::HeaderSize
+                                 + qint64(sizeof(uint32_t));
+    return m_table.listNode(node).nextChild > quint64(childrenBegin);
+}
+
+int32_t TreeModel::appendNode(const ChunkRecord &chunk, int32_t parent)
+{
+    return RiffScanner::appendRecord(m_table, parent, chunk, m_length);
+}
+
+void TreeModel::appendChunks(int listId, const QVector<ChunkRecord> &chunks)
+{
+    ProfileScope scope("insert rows");
+    scope.setArg(0, "rows", chunks.size());
+    const int row = m_table.childCount(listId);
+    beginInsertRows(indexOf(listId), row, row + chunks.size() - 1);
+    for (const ChunkRecord &chunk : chunks) {
+        appendNode(chunk, listId);
+    }
+    m_index.update(m_table);
+    endInsertRows();
+    m_modified = true;
+}
+
+void TreeModel::appendContainers(qint64 from)
+{
+    std::vector<ChunkRecord> containers;
+    qint64 next = m_length;
+    if (m_carved) {
+        const QVector<ChunkRecord> carved = RiffScanner::carveContainers(m_buffer,
+                                                                         from,
+                                                                         m_length,
+                                                                         QThreadPool::globalInstance());
+        containers.assign(carved.begin(), carved.end());
+    } else {
+        auto visit = [&](const ChunkRecord &chunk) {
+            containers.push_back(chunk);
+            return true;
+        };
+        next = m_reader ? RiffScanner::scanContainers(m_format, m_reader.get(), from, m_length, visit)
+                        : RiffScanner::scanContainers(m_format, m_buffer, from, m_length, visit);
+    }
+    m_table.listNode(ChunkTable::Root).nextChild = quint64(next);
+    if (containers.empty()) {
+        return;
+    }
+    const int row = m_table.childCount(ChunkTable::Root);
+    beginInsertRows({}, row, row + int(containers.size()) - 1);
+    for (const ChunkRecord &chunk : containers) {
+        appendNode(chunk, ChunkTable::Root);
+    }
+    m_index.update(m_table);
+    endInsertRows();
+    m_modified = true;
+}
+
+void TreeModel::listScanned(int listId, qint64 next)
+{
+    --m_workers[size_t(m_fetchWorkers.take(listId))].fetches;
+    ListNode &list = m_table.listNode(listId);
+    list.nextChild = quint64(next);
+    list.fetching = false;
+    m_modified = true;
+    m_fetchesCut = m_fetchesCut || list.nextChild < list.childrenEnd;
+    if (--m_pendingFetches == 0) {
+        emit loadFinished(!m_fetchesCut);
+        m_fetchesCut = false;
+    }
+}
+
+void TreeModel::hashFound(int node, int kind, quint64 hash)
+{
+    const quint64 key = hashKey(node, kind);
+    if (!m_hashing.remove(key)) {
+        return;
+    }
+    m_hashes.insert(key, hash);
+    const int column = kind == ChunkHash::Crc32Hash ? Crc32Column : HashColumn;
+    const QModelIndex index = createIndex(m_table.row(node), column, quintptr(node));
+    emit dataChanged(index, index);
+}
+
+// Forgets the hashes being computed, which the view asks for again when
+// repainted, and all the hashes known too when the file is another one.
+void TreeModel::dropHashes(bool all)
+{
+    const QSet<quint64> dropped = m_hashing;
+    m_hashing.clear();
+    if (all) {
+        m_hashes.clear();
+        return;
+    }
+    for (const quint64 key : dropped) {
+        const int32_t node = int32_t(key >> 1);
+        const int column = (key & 1) == ChunkHash::Crc32Hash ? Crc32Column : HashColumn;
+        const QModelIndex index = createIndex(m_table.row(node), column, quintptr(node));
+        emit dataChanged(index, index);
+    }
+}
+
+QVariant TreeModel::hashText(int32_t n, ChunkHash::Kind kind) const
+{
+    const quint64 key = hashKey(n, kind);
+    const int digits = kind == ChunkHash::Crc32Hash ? 8 : 16;
+    auto found = m_hashes.constFind(key);
+    if (found == m_hashes.constEnd()) {
+        if (m_buffer == nullptr) {
+            return {};
+        }
+        const ChunkNode &node = m_table.node(n);
+        const qint64 offset = ChunkHash::payloadOffset(node);
+        const qint64 length = ChunkHash::payloadLength(node, m_length);
+        if (length > InlineHashSize) {
+            if (!m_hashing.contains(key)) {
+                m_hashing.insert(key);
+                m_hasher->request(n, kind, offset, length);
+            }
+            return QString(QChar(0x2026));
         }
-        child = child->nextChunk();
+        const std::atomic<bool> never{false};
+        quint64 hash = 0;
+        ChunkHash::hashPayload(kind, m_buffer + offset, length, never, hash);
+        found = m_hashes.insert(key, hash);
     }
+    return QString("%1").arg(found.value(), digits, 16, QLatin1Char('0'));
+}
+
+int32_t TreeModel::nodeOf(const QModelIndex &index) const
+{
+    return index.isValid() ? int32_t(index.internalId()) : ChunkTable::Root;
+}
+
+QModelIndex TreeModel::indexOf(int32_t node) const
+{
+    return node == ChunkTable::Root ? QModelIndex{} : createIndex(m_table.row(node), 0, quintptr(node));
 }
 
 QVariant TreeModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid() || role != Qt::DisplayRole)
+    if (!index.isValid())
+        return {};
+
+    const ChunkNode &node = m_table.node(nodeOf(index));
+    if (role == Qt::ToolTipRole && node.flags != 0) {
+        return flagsText(node.flags);
+    }
+    if (role == Qt::ForegroundRole && (node.flags & (ChunkNode::Damaged | ChunkNode::Overrun))) {
+        return QBrush(Qt::red);
+    }
+    if (role != Qt::DisplayRole)
         return {};
 
-    const auto *item = static_cast<const TreeItem*>(index.internalPointer());
-    return item->data(index.column());
+    switch (index.column()) {
+    case ChunkColumn:
+        return m_labels.label(node);
+    case OffsetColumn:
+        return qint64(node.offset);
+    case SizeColumn:
+        return qint64(node.size);
+    case HashColumn:
+        return hashText(nodeOf(index), ChunkHash::Xxh64Hash);
+    case Crc32Column:
+        return hashText(nodeOf(index), ChunkHash::Crc32Hash);
+    default:
+        return {};
+    }
+}
+
+QString TreeModel::flagsText(uint32_t flags)
+{
+    QStringList text;
+    if (flags & ChunkNode::Placeholder) {
+        text << tr("The size is a placeholder, the chunk extends to the end of its parent");
+    }
+    if (flags & ChunkNode::Overrun) {
+        text << tr("The size goes beyond the end of its parent or the file");
+    }
+    if (flags & ChunkNode::Damaged) {
+        text << tr("Damaged data, skipped up to the next chunk header");
+    }
+    if (flags & ChunkNode::Resynced) {
+        text << tr("Found after damaged data");
+    }
+    return text.join('\n');
 }
 
 Qt::ItemFlags TreeModel::flags(const QModelIndex &index) const
@@ -95,8 +524,22 @@ Qt::ItemFlags TreeModel::flags(const QModelIndex &index) const
 QVariant TreeModel::headerData(int section, Qt::Orientation orientation,
                                int role) const
 {
-    return orientation == Qt::Horizontal && role == Qt::DisplayRole
-        ? rootItem->data(section) : QVariant{};
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return {};
+    switch (section) {
+    case ChunkColumn:
+        return tr("Chunk");
+    case OffsetColumn:
+        return tr("Offset");
+    case SizeColumn:
+        return tr("Size");
+    case HashColumn:
+        return tr("Hash");
+    case Crc32Column:
+        return tr("CRC32");
+    default:
+        return {};
+    }
 }
 
 QModelIndex TreeModel::index(int row, int column, const QModelIndex &parent) const
@@ -104,13 +547,10 @@ QModelIndex TreeModel::index(int row, int column, const QModelIndex &parent) con
     if (!hasIndex(row, column, parent))
         return {};
 
-    TreeItem *parentItem = parent.isValid()
-        ? static_cast<TreeItem*>(parent.internalPointer())
-        : rootItem.get();
-
-    if (auto *childItem = parentItem->child(row))
-        return createIndex(row, column, childItem);
-    return {};
+    const int32_t childNode = m_table.child(nodeOf(parent), row);
+    if (childNode == ChunkTable::NoNode)
+        return {};
+    return createIndex(row, column, quintptr(childNode));
 }
 
 QModelIndex TreeModel::parent(const QModelIndex &index) const
@@ -118,11 +558,8 @@ QModelIndex TreeModel::parent(const QModelIndex &index) const
     if (!index.isValid())
         return {};
 
-    auto *childItem = static_cast<TreeItem*>(index.internalPointer());
-    TreeItem *parentItem = childItem->parentItem();
-
-    return parentItem != rootItem.get()
-        ? createIndex(parentItem->row(), 0, parentItem) : QModelIndex{};
+    const int32_t parentNode = m_table.node(nodeOf(index)).parent;
+    return indexOf(parentNode);
 }
 
 int TreeModel::rowCount(const QModelIndex &parent) const
@@ -130,9 +567,5 @@ int TreeModel::rowCount(const QModelIndex &parent) const
     if (parent.column() > 0)
         return 0;
 
-    const TreeItem *parentItem = parent.isValid()
-        ? static_cast<const TreeItem*>(parent.internalPointer())
-        : rootItem.get();
-
-    return parentItem->childCount();
+    return m_table.childCount(nodeOf(parent));
 }
@@ -7,13 +7,20 @@
 
 #include <QAbstractItemModel>
 #include <QFile>
+#include <QHash>
 #include <QModelIndex>
+#include <QSet>
+#include <QThread>
 #include <QVariant>
 #include <memory>
+#include <vector>
 
+#include "chunkhash.h"
+#include "chunklabels.h"
+#include "chunkquery.h"
+#include "chunktable.h"
 #include "riff.h"
-
-class TreeItem;
+#include "riffscanner.h"
 
 class TreeModel : public QAbstractItemModel
 {
@@ -22,6 +29,9 @@ class TreeModel : public QAbstractItemModel
 public:
     Q_DISABLE_COPY_MOVE(TreeModel)
 
+    // the payload hashes are computed when their columns are shown
+    enum Column { ChunkColumn, OffsetColumn, SizeColumn, HashColumn, Crc32Column };
+
     explicit TreeModel(QObject *parent = nullptr);
     ~TreeModel() override;
 
@@ -34,14 +44,82 @@ public:
     QModelIndex parent(const QModelIndex &index) const override;
     int rowCount(const QModelIndex &parent = {}) const override;
     int columnCount(const QModelIndex &parent = {}) const override;
+    bool hasChildren(const QModelIndex &parent = {}) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    // carving shows the RIFF containers found anywhere in the buffer
+    bool loadData(const uint8_t *buffer, qint64 length, ChunkTable *cached = nullptr, bool carve = false);
+    // a file read a window at a time, which must outlive the model; there
+    // are no hashes, no carving and no following the file
+    bool loadWindows(FileWindows *windows);
+    bool extend(const uint8_t *buffer, qint64 length);
+    bool isLoading() const;
+    bool isModified() const;
+    bool isCarved() const;
+    // the container format, giving the byte order of the data
+    RiffScanner::Format format() const;
+    int chunkCount() const;
+    const ChunkTable &chunks() const;
+    // the chunks inserted so far by id, updated as they arrive
+    const ChunkIndex &chunkIndex() const;
+    QModelIndex indexAt(qint64 offset) const;
+    int32_t nodeOf(const QModelIndex &index) const;
+
+public slots:
+    void cancelLoading();
 
-    bool loadData(uint8_t *buffer);
+signals:
+    void loadProgress(qint64 done, qint64 total);
+    void loadFinished(bool completed);
+
+private slots:
+    void appendChunks(int listId, const QVector<ChunkRecord> &chunks);
+    void listScanned(int listId, qint64 next);
+    void hashFound(int node, int kind, quint64 hash);
 
 private:
-    void traverseRiff(const riff::RiffList<>::Chunk *listChunk, TreeItem *parent);
-    uint8_t *m_buffer{nullptr};
+    struct Worker
+    {
+        QThread *thread;
+        RiffScanner *scanner;
+        int fetches; // lists requested and not scanned yet
+    };
+
+    bool load(ChunkTable *cached);
+    void startScanners();
+    void stopScanners();
+    void appendContainers(qint64 from);
+    bool isScanned(int32_t node) const;
+    int32_t appendNode(const ChunkRecord &chunk, int32_t parent);
+    QVariant hashText(int32_t n, ChunkHash::Kind kind) const;
+    void dropHashes(bool all);
+    static QString flagsText(uint32_t flags);
+    QModelIndex indexOf(int32_t node) const;
+
+    const uint8_t *m_buffer{nullptr};
+    FileWindows *m_windows{nullptr};
+    // the reads of the GUI thread, the workers have their own
+    std::unique_ptr<FileWindows::Reader> m_reader;
+    qint64 m_length{0};
+    RiffScanner::Format m_format{RiffScanner::Format::Unknown};
+    int m_pendingFetches{0};
+    // a list of the fetches pending stopped before its end
+    bool m_fetchesCut{false};
+    bool m_modified{false};
+    bool m_carved{false};
+
+    ChunkTable m_table;
+    ChunkIndex m_index;
+    // shared by the rows with the same id, not reset with the file
+    mutable ChunkLabels m_labels;
+    std::vector<Worker> m_workers;
+    QHash<int32_t, int> m_fetchWorkers; // the worker scanning each list
 
-    std::unique_ptr<TreeItem> rootItem;
+    // hashes keyed by node and kind, requested as the view paints them
+    ChunkHasher *m_hasher;
+    mutable QHash<quint64, quint64> m_hashes;
+    mutable QSet<quint64> m_hashing;
 };
 
 #endif // TREEMODEL_H